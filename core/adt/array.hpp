@@ -50,9 +50,29 @@ namespace fc::adt {
       return append(bytes);
     }
 
+    /// Get element by index
+    outcome::result<Value> get(uint64_t index);
+
+    /// Get CBOR decoded element by index
+    template <typename T>
+    outcome::result<T> getCbor(uint64_t index) {
+      return amt_.getCbor<T>(index);
+    }
+
     /// Iterate over stored elements acquiring their index
     outcome::result<void> visit(const IndexedVisitor &visitor);
 
+    /**
+     * Iterate over elements with indices in range acquiring their index,
+     * elements before range are not loaded
+     * @param from - first index of range
+     * @param to - index after last index of range
+     * @param visitor - visitor
+     */
+    outcome::result<void> visit(uint64_t from,
+                                uint64_t to,
+                                const IndexedVisitor &visitor);
+
     /// Iterate over stored elements
     outcome::result<void> visit(const Visitor &visitor);
 
@@ -23,10 +23,20 @@ namespace fc::adt {
     return amt_.set(count, value);
   }
 
+  outcome::result<Array::Value> Array::get(uint64_t index) {
+    return amt_.get(index);
+  }
+
   outcome::result<void> Array::visit(const Array::IndexedVisitor &visitor) {
     return amt_.visit(visitor);
   }
 
+  outcome::result<void> Array::visit(uint64_t from,
+                                     uint64_t to,
+                                     const Array::IndexedVisitor &visitor) {
+    return amt_.visit(from, to, visitor);
+  }
+
   outcome::result<void> Array::visit(const Array::Visitor &visitor) {
     return amt_.visit(
         [&visitor](auto, const Value &value) { return visitor(value); });
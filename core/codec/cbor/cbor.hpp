@@ -9,10 +9,12 @@
 #include "codec/cbor/cbor_decode_stream.hpp"
 #include "codec/cbor/cbor_encode_stream.hpp"
 #include "codec/cbor/cbor_resolve.hpp"
+#include "codec/cbor/cbor_size_stream.hpp"
 
 namespace fc::codec::cbor {
   /**
-   * @brief CBOR encoding to byte-vector
+   * @brief CBOR encoding to byte-vector. Size is computed first, so value is
+   * encoded into one buffer without reallocation.
    * @tparam Type to be encoded
    * @param arg data to be encoded
    * @return encoded data
@@ -20,9 +22,29 @@ namespace fc::codec::cbor {
   template <typename T>
   outcome::result<std::vector<uint8_t>> encode(const T &arg) {
     try {
+      CborSizeStream sizer;
+      sizer << arg;
       CborEncodeStream encoder;
+      encoder.reserve(sizer.size());
       encoder << arg;
-      return encoder.data();
+      return std::move(encoder).data();
+    } catch (std::system_error &e) {
+      return outcome::failure(e.code());
+    }
+  }
+
+  /**
+   * @brief Size of CBOR encoding computed without encoding
+   * @tparam T - type of value
+   * @param arg - value to be sized
+   * @return size of encoded value
+   */
+  template <typename T>
+  outcome::result<size_t> encodedSize(const T &arg) {
+    try {
+      CborSizeStream sizer;
+      sizer << arg;
+      return sizer.size();
     } catch (std::system_error &e) {
       return outcome::failure(e.code());
     }
@@ -39,7 +61,7 @@ namespace fc::codec::cbor {
   outcome::result<T> decode(gsl::span<const uint8_t> input) {
     try {
       T data{};
-      CborDecodeStream decoder(input);
+      auto decoder = CborDecodeStream::borrow(input);
       decoder >> data;
       return data;
     } catch (std::system_error &e) {
@@ -7,11 +7,34 @@
 
 namespace fc::codec::cbor {
   CborDecodeStream::CborDecodeStream(gsl::span<const uint8_t> data)
-      : data_(std::make_shared<std::vector<uint8_t>>(data.begin(), data.end())),
-        parser_(std::make_shared<CborParser>()) {
+      : data_(std::make_shared<const std::vector<uint8_t>>(data.begin(),
+                                                           data.end())) {
+    init(*data_);
+  }
+
+  CborDecodeStream::CborDecodeStream(const CborDecodeStream &other)
+      : data_{other.data_}, parser_{other.parser_}, value_{other.value_} {
+    value_.parser = &parser_;
+  }
+
+  CborDecodeStream &CborDecodeStream::operator=(
+      const CborDecodeStream &other) {
+    data_ = other.data_;
+    parser_ = other.parser_;
+    value_ = other.value_;
+    value_.parser = &parser_;
+    return *this;
+  }
+
+  CborDecodeStream CborDecodeStream::borrow(gsl::span<const uint8_t> data) {
+    CborDecodeStream stream;
+    stream.init(data);
+    return stream;
+  }
+
+  void CborDecodeStream::init(gsl::span<const uint8_t> data) {
     if (CborNoError
-        != cbor_parser_init(
-               data_->data(), data_->size(), 0, parser_.get(), &value_)) {
+        != cbor_parser_init(data.data(), data.size(), 0, &parser_, &value_)) {
       outcome::raise(CborDecodeError::INVALID_CBOR);
     }
     value_.remaining = UINT32_MAX;
@@ -56,6 +79,25 @@ namespace fc::codec::cbor {
     return *this;
   }
 
+  CborDecodeStream &CborDecodeStream::operator>>(
+      gsl::span<const uint8_t> &bytes) {
+    if (!cbor_value_is_byte_string(&value_)) {
+      outcome::raise(CborDecodeError::WRONG_TYPE);
+    }
+    bytes = stringView();
+    return *this;
+  }
+
+  CborDecodeStream &CborDecodeStream::operator>>(std::string_view &str) {
+    if (!cbor_value_is_text_string(&value_)) {
+      outcome::raise(CborDecodeError::WRONG_TYPE);
+    }
+    auto bytes = stringView();
+    str = {reinterpret_cast<const char *>(bytes.data()),
+           static_cast<size_t>(bytes.size())};
+    return *this;
+  }
+
   CborDecodeStream &CborDecodeStream::operator>>(CID &cid) {
     if (!cbor_value_is_tag(&value_)) {
       outcome::raise(CborDecodeError::INVALID_CBOR_CID);
@@ -105,13 +147,13 @@ namespace fc::codec::cbor {
     if (CborNoError != cbor_value_advance(&value_)) {
       outcome::raise(CborDecodeError::INVALID_CBOR);
     }
-    if (value_.ptr != parser_->end) {
+    if (value_.ptr != parser_.end) {
       remaining += value_.remaining - 1;
       if (CborNoError
           != cbor_parser_init(value_.ptr,
-                              parser_->end - value_.ptr,
+                              parser_.end - value_.ptr,
                               0,
-                              parser_.get(),
+                              &parser_,
                               &value_)) {
         outcome::raise(CborDecodeError::INVALID_CBOR);
       }
@@ -149,15 +191,23 @@ namespace fc::codec::cbor {
   }
 
   std::vector<uint8_t> CborDecodeStream::raw() {
+    auto bytes = rawView();
+    return {bytes.begin(), bytes.end()};
+  }
+
+  gsl::span<const uint8_t> CborDecodeStream::rawView() {
     auto begin = value_.ptr;
     next();
-    return {begin, value_.ptr};
+    return gsl::make_span(begin, value_.ptr);
   }
 
   std::map<std::string, CborDecodeStream> CborDecodeStream::map() {
     if (!cbor_value_is_map(&value_)) {
       outcome::raise(CborDecodeError::WRONG_TYPE);
     }
+    if (!cbor_value_is_length_known(&value_)) {
+      outcome::raise(CborDecodeError::INVALID_CBOR);
+    }
     auto stream = container();
     next();
     std::map<std::string, CborDecodeStream> map;
@@ -167,7 +217,6 @@ namespace fc::codec::cbor {
       stream >> key;
       begin = stream.value_.ptr;
       auto stream2 = stream;
-      stream2.parser_ = std::make_shared<CborParser>();
       if (CborNoError != cbor_value_skip_tag(&stream.value_)) {
         outcome::raise(CborDecodeError::INVALID_CBOR);
       }
@@ -178,7 +227,7 @@ namespace fc::codec::cbor {
           != cbor_parser_init(begin,
                               stream.value_.ptr - begin,
                               0,
-                              stream2.parser_.get(),
+                              &stream2.parser_,
                               &stream2.value_)) {
         outcome::raise(CborDecodeError::INVALID_CBOR);
       }
@@ -187,6 +236,26 @@ namespace fc::codec::cbor {
     return map;
   }
 
+  size_t CborDecodeStream::mapLength() const {
+    size_t length;
+    if (CborNoError != cbor_value_get_map_length(&value_, &length)) {
+      outcome::raise(CborDecodeError::INVALID_CBOR);
+    }
+    return length;
+  }
+
+  CborDecodeStream CborDecodeStream::mapEntries() {
+    if (!cbor_value_is_map(&value_)) {
+      outcome::raise(CborDecodeError::WRONG_TYPE);
+    }
+    if (!cbor_value_is_length_known(&value_)) {
+      outcome::raise(CborDecodeError::INVALID_CBOR);
+    }
+    auto stream = container();
+    next();
+    return stream;
+  }
+
   size_t CborDecodeStream::bytesLength() const {
     if (!cbor_value_is_byte_string(&value_)) {
       outcome::raise(CborDecodeError::WRONG_TYPE);
@@ -203,6 +272,20 @@ namespace fc::codec::cbor {
     if (CborNoError != cbor_value_enter_container(&value_, &stream.value_)) {
       outcome::raise(CborDecodeError::INVALID_CBOR);
     }
+    stream.value_.parser = &stream.parser_;
     return stream;
   }
+
+  gsl::span<const uint8_t> CborDecodeStream::stringView() {
+    if (!cbor_value_is_length_known(&value_)) {
+      outcome::raise(CborDecodeError::INVALID_CBOR);
+    }
+    size_t size;
+    if (CborNoError != cbor_value_get_string_length(&value_, &size)) {
+      outcome::raise(CborDecodeError::INVALID_CBOR);
+    }
+    next();
+    // definite length payload immediately precedes next element
+    return gsl::make_span(value_.ptr - size, size);
+  }
 }  // namespace fc::codec::cbor
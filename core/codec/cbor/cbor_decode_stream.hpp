@@ -8,18 +8,31 @@
 
 #include "codec/cbor/cbor_common.hpp"
 
+#include <string_view>
 #include <vector>
 
 #include <cbor.h>
 #include <gsl/span>
 
 namespace fc::codec::cbor {
-  /** Decodes CBOR */
+  /**
+   * Decodes CBOR. Substreams share parsed data and are created without heap
+   * allocation.
+   */
   class CborDecodeStream {
    public:
     static constexpr auto is_cbor_decoder_stream = true;
 
+    /// Decodes copy of data, so stream doesn't depend on lifetime of data
     explicit CborDecodeStream(gsl::span<const uint8_t> data);
+    CborDecodeStream(const CborDecodeStream &other);
+    CborDecodeStream &operator=(const CborDecodeStream &other);
+
+    /**
+     * Decodes data without copying it. Data must outlive stream, its
+     * substreams and views decoded from them.
+     */
+    static CborDecodeStream borrow(gsl::span<const uint8_t> data);
 
     /** Decodes integer or bool */
     template <
@@ -85,7 +98,7 @@ namespace fc::codec::cbor {
       for (auto i = 0u; i < n; ++i) {
         T value{};
         l >> value;
-        values.push_back(value);
+        values.push_back(std::move(value));
       }
       return *this;
     }
@@ -105,6 +118,16 @@ namespace fc::codec::cbor {
     CborDecodeStream &operator>>(std::vector<uint8_t> &bytes);
     /** Decodes string */
     CborDecodeStream &operator>>(std::string &str);
+    /**
+     * Decodes bytes as view of decoded data without copying.
+     * View is valid while data of stream is alive.
+     */
+    CborDecodeStream &operator>>(gsl::span<const uint8_t> &bytes);
+    /**
+     * Decodes string as view of decoded data without copying.
+     * View is valid while data of stream is alive.
+     */
+    CborDecodeStream &operator>>(std::string_view &str);
     /** Decodes CID */
     CborDecodeStream &operator>>(CID &cid);
     /** Creates list container decode substream */
@@ -123,16 +146,40 @@ namespace fc::codec::cbor {
     /** Reads CBOR bytes of current element (and advances to the next element)
      */
     std::vector<uint8_t> raw();
-    /** Creates map container decode substream map */
+    /**
+     * Returns CBOR bytes of current element as view of decoded data and
+     * advances to the next element
+     */
+    gsl::span<const uint8_t> rawView();
+    /**
+     * Creates map container decode substream map. Indefinite length map is
+     * rejected with INVALID_CBOR, like indefinite length list, because
+     * DAG-CBOR allows definite lengths only.
+     */
     std::map<std::string, CborDecodeStream> map();
+    /** Returns count of entries in current element map container */
+    size_t mapLength() const;
+    /**
+     * Creates map container decode substream of alternating keys and values.
+     * Keys may be read as string views, values are decoded or skipped in
+     * place, so no per entry allocation is made. Indefinite length map is
+     * rejected like by map().
+     */
+    CborDecodeStream mapEntries();
     /// Returns bytestring length
     size_t bytesLength() const;
 
    private:
+    CborDecodeStream() = default;
+    void init(gsl::span<const uint8_t> data);
     CborDecodeStream container() const;
+    /// Returns definite length string payload and advances to next element
+    gsl::span<const uint8_t> stringView();
 
-    std::shared_ptr<std::vector<uint8_t>> data_;
-    std::shared_ptr<CborParser> parser_;
+    /// Copy of data, null if data is borrowed
+    std::shared_ptr<const std::vector<uint8_t>> data_;
+    /// Parser is owned by stream, value points to it
+    CborParser parser_{};
     CborValue value_{};
   };
 }  // namespace fc::codec::cbor
@@ -5,6 +5,8 @@
 
 #include "codec/cbor/cbor_encode_stream.hpp"
 
+#include <algorithm>
+
 namespace fc::codec::cbor {
   CborEncodeStream &CborEncodeStream::operator<<(
       const std::vector<uint8_t> &bytes) {
@@ -14,29 +16,16 @@ namespace fc::codec::cbor {
   CborEncodeStream &CborEncodeStream::operator<<(
       gsl::span<const uint8_t> bytes) {
     addCount(1);
-
-    std::vector<uint8_t> encoded(9 + bytes.size());
-    CborEncoder encoder;
-    cbor_encoder_init(&encoder, encoded.data(), encoded.size(), 0);
-    cbor_encode_byte_string(&encoder, bytes.data(), bytes.size());
-    data_.insert(data_.end(),
-                 encoded.begin(),
-                 encoded.begin()
-                     + cbor_encoder_get_buffer_size(&encoder, encoded.data()));
+    writeString(kBytes, bytes);
     return *this;
   }
 
   CborEncodeStream &CborEncodeStream::operator<<(const std::string &str) {
     addCount(1);
-
-    std::vector<uint8_t> encoded(9 + str.size());
-    CborEncoder encoder;
-    cbor_encoder_init(&encoder, encoded.data(), encoded.size(), 0);
-    cbor_encode_text_string(&encoder, str.data(), str.size());
-    data_.insert(data_.end(),
-                 encoded.begin(),
-                 encoded.begin()
-                     + cbor_encoder_get_buffer_size(&encoder, encoded.data()));
+    writeString(
+        kText,
+        gsl::make_span(reinterpret_cast<const uint8_t *>(str.data()),
+                       str.size()));
     return *this;
   }
 
@@ -45,26 +34,23 @@ namespace fc::codec::cbor {
     if (maybe_cid_bytes.has_error()) {
       outcome::raise(CborEncodeError::INVALID_CID);
     }
-    auto cid_bytes = maybe_cid_bytes.value();
-    cid_bytes.insert(cid_bytes.begin(), 0);
-
-    std::array<uint8_t, 9> encoded{0};
-    CborEncoder encoder;
-    cbor_encoder_init(&encoder, encoded.data(), encoded.size(), 0);
-    cbor_encode_tag(&encoder, kCidTag);
-    data_.insert(data_.end(),
-                 encoded.begin(),
-                 encoded.begin()
-                     + cbor_encoder_get_buffer_size(&encoder, encoded.data()));
-    *this << cid_bytes;
+    auto &cid_bytes = maybe_cid_bytes.value();
+    addCount(1);
+    writeHead(kTag, kCidTag);
+    // multibase identity prefix
+    writeHead(kBytes, cid_bytes.size() + 1);
+    data_.push_back(0);
+    data_.insert(data_.end(), cid_bytes.begin(), cid_bytes.end());
     return *this;
   }
 
   CborEncodeStream &CborEncodeStream::operator<<(
       const CborEncodeStream &other) {
     addCount(other.is_list_ ? 1 : other.count_);
-    auto other_data = other.data();
-    data_.insert(data_.end(), other_data.begin(), other_data.end());
+    if (other.is_list_) {
+      writeHead(kArray, other.count_);
+    }
+    data_.insert(data_.end(), other.data_.begin(), other.data_.end());
     return *this;
   }
 
@@ -82,28 +68,23 @@ namespace fc::codec::cbor {
   CborEncodeStream &CborEncodeStream::operator<<(
       const std::map<std::string, CborEncodeStream> &map) {
     addCount(1);
+    writeHead(kMap, map.size());
 
-    std::array<uint8_t, 9> prefix{0};
-    CborEncoder encoder;
-    CborEncoder container;
-    cbor_encoder_init(&encoder, prefix.data(), prefix.size(), 0);
-    cbor_encoder_create_map(&encoder, &container, map.size());
-    data_.insert(data_.end(),
-                 prefix.begin(),
-                 prefix.begin()
-                     + cbor_encoder_get_buffer_size(&container, prefix.data()));
-
-    std::map<std::vector<uint8_t>, std::vector<uint8_t>, LessCborKey> sorted;
+    std::map<std::vector<uint8_t>, const CborEncodeStream *, LessCborKey>
+        sorted;
     for (const auto &pair : map) {
       if (pair.second.count_ != 1) {
         outcome::raise(CborEncodeError::EXPECTED_MAP_VALUE_SINGLE);
       }
-      sorted.insert(std::make_pair((CborEncodeStream() << pair.first).data(),
-                                   pair.second.data()));
+      sorted.emplace((CborEncodeStream() << pair.first).data_, &pair.second);
     }
     for (const auto &pair : sorted) {
       data_.insert(data_.end(), pair.first.begin(), pair.first.end());
-      data_.insert(data_.end(), pair.second.begin(), pair.second.end());
+      auto &value = *pair.second;
+      if (value.is_list_) {
+        writeHead(kArray, value.count_);
+      }
+      data_.insert(data_.end(), value.data_.begin(), value.data_.end());
     }
 
     return *this;
@@ -111,33 +92,29 @@ namespace fc::codec::cbor {
 
   CborEncodeStream &CborEncodeStream::operator<<(std::nullptr_t) {
     addCount(1);
-
-    std::array<uint8_t, 1> prefix{0};
-    CborEncoder encoder;
-    cbor_encoder_init(&encoder, prefix.data(), prefix.size(), 0);
-    cbor_encode_null(&encoder);
-    data_.insert(
-        data_.end(),
-        prefix.begin(),
-        prefix.begin() + cbor_encoder_get_buffer_size(&encoder, prefix.data()));
+    data_.push_back(kNull);
     return *this;
   }
 
-  std::vector<uint8_t> CborEncodeStream::data() const {
+  std::vector<uint8_t> CborEncodeStream::data() const & {
     if (!is_list_) {
       return data_;
     }
-    std::array<uint8_t, 9> prefix{0};
-    CborEncoder encoder;
-    CborEncoder container;
-    cbor_encoder_init(&encoder, prefix.data(), prefix.size(), 0);
-    cbor_encoder_create_array(&encoder, &container, count_);
-    std::vector<uint8_t> result(
-        prefix.begin(),
-        prefix.begin()
-            + cbor_encoder_get_buffer_size(&container, prefix.data()));
-    result.insert(result.end(), data_.begin(), data_.end());
-    return result;
+    CborEncodeStream result;
+    result.data_.reserve(9 + data_.size());
+    result << *this;
+    return std::move(result.data_);
+  }
+
+  std::vector<uint8_t> CborEncodeStream::data() && {
+    if (!is_list_) {
+      return std::move(data_);
+    }
+    return data();
+  }
+
+  void CborEncodeStream::reserve(size_t size) {
+    data_.reserve(size);
   }
 
   CborEncodeStream CborEncodeStream::list() {
@@ -158,7 +135,51 @@ namespace fc::codec::cbor {
     return s;
   }
 
+  CborEncodeStream &CborEncodeStream::tuple(size_t count) {
+    container(kArray, count, count);
+    return *this;
+  }
+
+  void CborEncodeStream::container(uint8_t major, size_t size, size_t fields) {
+    addCount(1);
+    writeHead(major, size);
+    tuple_fields_ += fields;
+  }
+
   void CborEncodeStream::addCount(size_t count) {
-    count_ += count;
+    auto fields = std::min(count, tuple_fields_);
+    tuple_fields_ -= fields;
+    count_ += count - fields;
+  }
+
+  void CborEncodeStream::writeHead(uint8_t major, uint64_t value) {
+    major <<= 5;
+    if (value < 24) {
+      data_.push_back(major | value);
+      return;
+    }
+    size_t size;
+    if (value <= UINT8_MAX) {
+      data_.push_back(major | 24);
+      size = 1;
+    } else if (value <= UINT16_MAX) {
+      data_.push_back(major | 25);
+      size = 2;
+    } else if (value <= UINT32_MAX) {
+      data_.push_back(major | 26);
+      size = 4;
+    } else {
+      data_.push_back(major | 27);
+      size = 8;
+    }
+    for (auto i = size; i != 0; --i) {
+      data_.push_back(static_cast<uint8_t>(value >> (8 * (i - 1))));
+    }
+  }
+
+  void CborEncodeStream::writeString(uint8_t major,
+                                     gsl::span<const uint8_t> bytes) {
+    writeHead(major, bytes.size());
+    data_.insert(data_.end(), bytes.begin(), bytes.end());
   }
 }  // namespace fc::codec::cbor
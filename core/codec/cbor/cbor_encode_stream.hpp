@@ -8,13 +8,18 @@
 
 #include "codec/cbor/cbor_common.hpp"
 
+#include <algorithm>
 #include <array>
 #include <vector>
 
 #include <cbor.h>
 
 namespace fc::codec::cbor {
-  /** Encodes CBOR */
+  /**
+   * Encodes CBOR. Items are written directly to stream buffer, substreams are
+   * copied into parent buffer once. Tuples, vectors and maps of values are
+   * written to parent buffer without substream, header first.
+   */
   class CborEncodeStream {
    public:
     static constexpr auto is_cbor_encoder_stream = true;
@@ -25,20 +30,18 @@ namespace fc::codec::cbor {
         typename = std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>>>
     CborEncodeStream &operator<<(T num) {
       addCount(1);
-      std::array<uint8_t, 9> buffer{0};
-      CborEncoder encoder;
-      cbor_encoder_init(&encoder, buffer.data(), buffer.size(), 0);
       if constexpr (std::is_same_v<T, bool>) {
-        cbor_encode_boolean(&encoder, num);
+        data_.push_back(num ? kTrue : kFalse);
       } else if constexpr (std::is_unsigned_v<T>) {
-        cbor_encode_uint(&encoder, static_cast<uint64_t>(num));
+        writeHead(kUnsigned, static_cast<uint64_t>(num));
       } else {
-        cbor_encode_int(&encoder, static_cast<int64_t>(num));
+        auto num64 = static_cast<int64_t>(num);
+        if (num64 < 0) {
+          writeHead(kNegative, static_cast<uint64_t>(-1 - num64));
+        } else {
+          writeHead(kUnsigned, static_cast<uint64_t>(num64));
+        }
       }
-      data_.insert(data_.end(),
-                   buffer.begin(),
-                   buffer.begin()
-                       + cbor_encoder_get_buffer_size(&encoder, buffer.data()));
       return *this;
     }
 
@@ -56,21 +59,21 @@ namespace fc::codec::cbor {
     /// Encodes elements into list
     template <typename T>
     CborEncodeStream &operator<<(const gsl::span<T> &values) {
-      auto l = list();
+      tuple(values.size());
       for (auto &value : values) {
-        l << value;
+        *this << value;
       }
-      return *this << l;
+      return *this;
     }
 
     /// Encodes elements into map
     template <typename T>
     CborEncodeStream &operator<<(const std::map<std::string, T> &items) {
-      auto m = map();
-      for (auto &item : items) {
-        m[item.first] << item.second;
+      container(kMap, items.size(), 2 * items.size());
+      for (auto item : sortedKeys(items)) {
+        *this << item->first << item->second;
       }
-      return *this << m;
+      return *this;
     }
 
     /// Encodes vector into list
@@ -101,20 +104,72 @@ namespace fc::codec::cbor {
     /** Encodes null */
     CborEncodeStream &operator<<(std::nullptr_t);
     /** Returns CBOR bytes of encoded elements */
-    std::vector<uint8_t> data() const;
+    std::vector<uint8_t> data() const &;
+    /** Returns CBOR bytes of encoded elements, moving buffer out of stream */
+    std::vector<uint8_t> data() &&;
+    /** Reserves buffer for size bytes, e.g. computed by CborSizeStream */
+    void reserve(size_t size);
     /** Creates list container encode substream */
     static CborEncodeStream list();
     /** Creates map container encode substream map */
     static std::map<std::string, CborEncodeStream> map();
     /** Wraps CBOR bytes */
     static CborEncodeStream wrap(gsl::span<const uint8_t> data, size_t count);
+    /**
+     * Writes list header of tuple directly to stream, following count
+     * elements are tuple fields
+     * @param count - count of tuple fields
+     */
+    CborEncodeStream &tuple(size_t count);
 
    private:
+    static constexpr uint8_t kUnsigned = 0;
+    static constexpr uint8_t kNegative = 1;
+    static constexpr uint8_t kBytes = 2;
+    static constexpr uint8_t kText = 3;
+    static constexpr uint8_t kArray = 4;
+    static constexpr uint8_t kMap = 5;
+    static constexpr uint8_t kTag = 6;
+    static constexpr uint8_t kFalse = 0xF4;
+    static constexpr uint8_t kTrue = 0xF5;
+    static constexpr uint8_t kNull = 0xF6;
+
+    /**
+     * Orders map items like their encoded keys, shorter keys first
+     * @return pointers to items in order
+     */
+    template <typename T>
+    static auto sortedKeys(const std::map<std::string, T> &items) {
+      std::vector<const typename std::map<std::string, T>::value_type *>
+          sorted;
+      sorted.reserve(items.size());
+      for (auto &item : items) {
+        sorted.push_back(&item);
+      }
+      std::stable_sort(
+          sorted.begin(), sorted.end(), [](auto lhs, auto rhs) {
+            return lhs->first.size() < rhs->first.size();
+          });
+      return sorted;
+    }
+
     void addCount(size_t count);
+    /**
+     * Writes container header, following fields elements are its content
+     * @param major - major type of container
+     * @param size - size in header
+     * @param fields - count of following elements in container
+     */
+    void container(uint8_t major, size_t size, size_t fields);
+    /// Writes major type with argument in shortest form
+    void writeHead(uint8_t major, uint64_t value);
+    void writeString(uint8_t major, gsl::span<const uint8_t> bytes);
 
     bool is_list_{false};
     std::vector<uint8_t> data_{};
     size_t count_{0};
+    /// Count of following elements which are fields of tuple, not counted
+    size_t tuple_fields_{0};
   };
 }  // namespace fc::codec::cbor
 
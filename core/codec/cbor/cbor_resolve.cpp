@@ -5,6 +5,8 @@
 
 #include "codec/cbor/cbor_resolve.hpp"
 
+#include <charconv>
+
 OUTCOME_CPP_DEFINE_CATEGORY(fc::codec::cbor, CborResolveError, e) {
   using fc::codec::cbor::CborResolveError;
   switch (e) {
@@ -25,7 +27,7 @@ namespace fc::codec::cbor {
   outcome::result<std::pair<std::vector<uint8_t>, Path>> resolve(
       gsl::span<const uint8_t> node, const Path &path) {
     try {
-      CborDecodeStream stream(node);
+      auto stream = CborDecodeStream::borrow(node);
       auto part = path.begin();
       for (; part != path.end(); part++) {
         if (stream.isCid()) {
@@ -33,15 +35,12 @@ namespace fc::codec::cbor {
         }
         if (stream.isList()) {
           size_t index;
-          size_t index_chars;
-          try {
-            index = std::stoul(*part, &index_chars);
-          } catch (std::invalid_argument &) {
-            return CborResolveError::INT_KEY_EXPECTED;
-          } catch (std::out_of_range &) {
+          auto end = part->data() + part->size();
+          auto parsed = std::from_chars(part->data(), end, index);
+          if (parsed.ec == std::errc::result_out_of_range) {
             return CborResolveError::KEY_NOT_FOUND;
           }
-          if (index_chars != part->size()) {
+          if (parsed.ec != std::errc{} || parsed.ptr != end) {
             return CborResolveError::INT_KEY_EXPECTED;
           }
           if (index >= stream.listLength()) {
@@ -52,11 +51,22 @@ namespace fc::codec::cbor {
             stream.next();
           }
         } else if (stream.isMap()) {
-          auto map = stream.map();
-          if (map.find(*part) == map.end()) {
+          auto n_entries = stream.mapLength();
+          auto entries = stream.mapEntries();
+          auto found = false;
+          for (size_t i = 0; i < n_entries; ++i) {
+            std::string_view key;
+            entries >> key;
+            if (key == *part) {
+              found = true;
+              break;
+            }
+            entries.next();
+          }
+          if (!found) {
             return CborResolveError::KEY_NOT_FOUND;
           }
-          stream = map.at(*part);
+          stream = entries;
         } else {
           return CborResolveError::CONTAINER_EXPECTED;
         }
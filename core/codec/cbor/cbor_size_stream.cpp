@@ -0,0 +1,101 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "codec/cbor/cbor_size_stream.hpp"
+
+#include <algorithm>
+
+namespace fc::codec::cbor {
+  CborSizeStream &CborSizeStream::operator<<(
+      const std::vector<uint8_t> &bytes) {
+    return *this << gsl::make_span(bytes);
+  }
+
+  CborSizeStream &CborSizeStream::operator<<(gsl::span<const uint8_t> bytes) {
+    addCount(1);
+    size_ += headSize(bytes.size()) + bytes.size();
+    return *this;
+  }
+
+  CborSizeStream &CborSizeStream::operator<<(const std::string &str) {
+    addCount(1);
+    size_ += headSize(str.size()) + str.size();
+    return *this;
+  }
+
+  CborSizeStream &CborSizeStream::operator<<(
+      const libp2p::multi::ContentIdentifier &cid) {
+    auto maybe_cid_bytes = libp2p::multi::ContentIdentifierCodec::encode(cid);
+    if (maybe_cid_bytes.has_error()) {
+      outcome::raise(CborEncodeError::INVALID_CID);
+    }
+    // multibase identity prefix
+    auto size = maybe_cid_bytes.value().size() + 1;
+    addCount(1);
+    size_ += headSize(kCidTag) + headSize(size) + size;
+    return *this;
+  }
+
+  CborSizeStream &CborSizeStream::operator<<(const CborSizeStream &other) {
+    addCount(other.is_list_ ? 1 : other.count_);
+    size_ += other.size();
+    return *this;
+  }
+
+  CborSizeStream &CborSizeStream::operator<<(
+      const std::map<std::string, CborSizeStream> &map) {
+    addCount(1);
+    size_ += headSize(map.size());
+    for (const auto &pair : map) {
+      if (pair.second.count_ != 1) {
+        outcome::raise(CborEncodeError::EXPECTED_MAP_VALUE_SINGLE);
+      }
+      size_ += headSize(pair.first.size()) + pair.first.size()
+               + pair.second.size();
+    }
+    return *this;
+  }
+
+  CborSizeStream &CborSizeStream::operator<<(std::nullptr_t) {
+    addCount(1);
+    size_ += 1;
+    return *this;
+  }
+
+  size_t CborSizeStream::size() const {
+    return is_list_ ? headSize(count_) + size_ : size_;
+  }
+
+  CborSizeStream CborSizeStream::list() {
+    CborSizeStream stream;
+    stream.is_list_ = true;
+    return stream;
+  }
+
+  std::map<std::string, CborSizeStream> CborSizeStream::map() {
+    return {};
+  }
+
+  CborSizeStream CborSizeStream::wrap(gsl::span<const uint8_t> data,
+                                      size_t count) {
+    CborSizeStream s;
+    s.size_ = data.size();
+    s.count_ = count;
+    return s;
+  }
+
+  CborSizeStream &CborSizeStream::tuple(size_t count) {
+    addCount(1);
+    size_ += headSize(count);
+    tuple_fields_ += count;
+    return *this;
+  }
+
+  void CborSizeStream::addCount(size_t count) {
+    auto fields = std::min(count, tuple_fields_);
+    tuple_fields_ -= fields;
+    count_ += count - fields;
+  }
+}  // namespace fc::codec::cbor
@@ -0,0 +1,141 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_CODEC_CBOR_CBOR_SIZE_STREAM_HPP
+#define CPP_FILECOIN_CORE_CODEC_CBOR_CBOR_SIZE_STREAM_HPP
+
+#include "codec/cbor/cbor_common.hpp"
+
+#include <array>
+#include <map>
+#include <vector>
+
+#include <gsl/span>
+
+namespace fc::codec::cbor {
+  /**
+   * Computes size of CBOR encoding without encoding. Accepts same elements as
+   * CborEncodeStream, so any CBOR_ENCODE definition works with it.
+   */
+  class CborSizeStream {
+   public:
+    static constexpr auto is_cbor_encoder_stream = true;
+
+    /// Returns size of CBOR head of major type with argument
+    static constexpr size_t headSize(uint64_t value) {
+      if (value < 24) {
+        return 1;
+      }
+      if (value <= UINT8_MAX) {
+        return 2;
+      }
+      if (value <= UINT16_MAX) {
+        return 3;
+      }
+      if (value <= UINT32_MAX) {
+        return 5;
+      }
+      return 9;
+    }
+
+    /** Sizes integer or bool */
+    template <
+        typename T,
+        typename = std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>>>
+    CborSizeStream &operator<<(T num) {
+      addCount(1);
+      if constexpr (std::is_same_v<T, bool>) {
+        size_ += 1;
+      } else if constexpr (std::is_unsigned_v<T>) {
+        size_ += headSize(static_cast<uint64_t>(num));
+      } else {
+        auto num64 = static_cast<int64_t>(num);
+        size_ += headSize(static_cast<uint64_t>(num64 < 0 ? -1 - num64
+                                                          : num64));
+      }
+      return *this;
+    }
+
+    /// Sizes nullable optional value
+    template <typename T>
+    CborSizeStream &operator<<(const boost::optional<T> &optional) {
+      if (optional) {
+        *this << *optional;
+      } else {
+        *this << nullptr;
+      }
+      return *this;
+    }
+
+    /// Sizes elements as list
+    template <typename T>
+    CborSizeStream &operator<<(const gsl::span<T> &values) {
+      auto l = list();
+      for (auto &value : values) {
+        l << value;
+      }
+      return *this << l;
+    }
+
+    /// Sizes elements as map
+    template <typename T>
+    CborSizeStream &operator<<(const std::map<std::string, T> &items) {
+      auto m = map();
+      for (auto &item : items) {
+        m[item.first] << item.second;
+      }
+      return *this << m;
+    }
+
+    /// Sizes vector as list
+    template <typename T>
+    CborSizeStream &operator<<(const std::vector<T> &values) {
+      return *this << gsl::make_span(values);
+    }
+
+    /// Sizes array as list
+    template <class T, size_t size>
+    CborSizeStream &operator<<(const std::array<T, size> &values) {
+      return *this << gsl::make_span(values);
+    }
+
+    /** Sizes bytes */
+    CborSizeStream &operator<<(const std::vector<uint8_t> &bytes);
+    /** Sizes bytes */
+    CborSizeStream &operator<<(gsl::span<const uint8_t> bytes);
+    /** Sizes string */
+    CborSizeStream &operator<<(const std::string &str);
+    /** Sizes CID */
+    CborSizeStream &operator<<(const libp2p::multi::ContentIdentifier &cid);
+    /** Sizes list container substream */
+    CborSizeStream &operator<<(const CborSizeStream &other);
+    /** Sizes map container substream map */
+    CborSizeStream &operator<<(
+        const std::map<std::string, CborSizeStream> &map);
+    /** Sizes null */
+    CborSizeStream &operator<<(std::nullptr_t);
+    /** Returns size of encoded elements */
+    size_t size() const;
+    /** Creates list container substream */
+    static CborSizeStream list();
+    /** Creates map container substream map */
+    static std::map<std::string, CborSizeStream> map();
+    /** Sizes wrapped CBOR bytes */
+    static CborSizeStream wrap(gsl::span<const uint8_t> data, size_t count);
+    /** Sizes list header of tuple, following count elements are its fields */
+    CborSizeStream &tuple(size_t count);
+
+   private:
+    void addCount(size_t count);
+
+    bool is_list_{false};
+    size_t size_{0};
+    size_t count_{0};
+    /// Count of following elements which are fields of tuple, not counted
+    size_t tuple_fields_{0};
+  };
+}  // namespace fc::codec::cbor
+
+#endif  // CPP_FILECOIN_CORE_CODEC_CBOR_CBOR_SIZE_STREAM_HPP
@@ -0,0 +1,114 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_CODEC_CBOR_CBOR_TUPLE_VIEW_HPP
+#define CPP_FILECOIN_CORE_CODEC_CBOR_CBOR_TUPLE_VIEW_HPP
+
+#include "codec/cbor/cbor.hpp"
+
+namespace fc::codec::cbor {
+
+  /**
+   * Lazy view of CBOR encoded tuple declared with CBOR_TUPLE. Offsets of
+   * fields are indexed once, fields are decoded on demand, e.g.
+   * view.get<&BlockHeader::height>().
+   * @tparam T - tuple type
+   */
+  template <typename T>
+  class CborTupleView {
+    using Fields = decltype(cborTupleFields(static_cast<const T *>(nullptr)));
+
+   public:
+    /// Count of tuple fields
+    static constexpr size_t kSize = std::tuple_size_v<Fields>;
+
+    /// Type of field by member pointer
+    template <auto member>
+    using Field = std::decay_t<decltype(std::declval<const T &>().*member)>;
+
+    /**
+     * Index fields of encoded tuple
+     * @param bytes - encoded tuple, owned by view
+     */
+    static outcome::result<CborTupleView> make(std::vector<uint8_t> bytes) {
+      CborTupleView view;
+      view.bytes_ = std::move(bytes);
+      try {
+        auto s = CborDecodeStream::borrow(view.bytes_);
+        if (!s.isList()) {
+          return CborDecodeError::WRONG_TYPE;
+        }
+        if (s.listLength() != kSize) {
+          return CborDecodeError::WRONG_SIZE;
+        }
+        auto l = s.list();
+        for (auto &field : view.fields_) {
+          auto raw = l.rawView();
+          field = {raw.data() - view.bytes_.data(), raw.size()};
+        }
+      } catch (std::system_error &e) {
+        return outcome::failure(e.code());
+      }
+      return view;
+    }
+
+    /// Encoded field by index
+    gsl::span<const uint8_t> raw(size_t index) const {
+      auto &field = fields_.at(index);
+      return gsl::make_span(bytes_).subspan(field.first, field.second);
+    }
+
+    /// Encoded field by member pointer
+    template <auto member>
+    gsl::span<const uint8_t> raw() const {
+      return raw(index<member>());
+    }
+
+    /// Decode field by member pointer
+    template <auto member>
+    outcome::result<Field<member>> get() const {
+      return decode<Field<member>>(raw<member>());
+    }
+
+    /// Index of field in tuple by member pointer
+    template <auto member, size_t i = 0>
+    static constexpr size_t index() {
+      static_assert(i < kSize, "Member is not a tuple field");
+      if constexpr (i < kSize) {
+        constexpr auto field =
+            std::get<i>(cborTupleFields(static_cast<const T *>(nullptr)));
+        if constexpr (isSame<field, member>()) {
+          return i;
+        } else {
+          return index<member, i + 1>();
+        }
+      }
+      return kSize;
+    }
+
+    /// Encoded tuple
+    const std::vector<uint8_t> &bytes() const {
+      return bytes_;
+    }
+
+   private:
+    CborTupleView() = default;
+
+    template <auto lhs, auto rhs>
+    static constexpr bool isSame() {
+      if constexpr (std::is_same_v<decltype(lhs), decltype(rhs)>) {
+        return lhs == rhs;
+      }
+      return false;
+    }
+
+    std::vector<uint8_t> bytes_;
+    /// Offset and size of each field
+    std::array<std::pair<size_t, size_t>, kSize> fields_;
+  };
+
+}  // namespace fc::codec::cbor
+
+#endif  // CPP_FILECOIN_CORE_CODEC_CBOR_CBOR_TUPLE_VIEW_HPP
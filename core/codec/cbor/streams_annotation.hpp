@@ -6,6 +6,8 @@
 #ifndef CPP_FILECOIN_STREAMS_ANNOTATION_HPP
 #define CPP_FILECOIN_STREAMS_ANNOTATION_HPP
 
+#include <tuple>
+
 #define CBOR_ENCODE(type, var)                                            \
   template <class Stream,                                                 \
             typename = std::enable_if_t<                                  \
@@ -63,9 +65,62 @@
                 _CBOR_TUPLE_1)  \
   (op, __VA_ARGS__)
 
-#define CBOR_ENCODE_TUPLE(T, ...)                        \
-  CBOR_ENCODE(T, t) {                                    \
-    return s << (s.list() _CBOR_TUPLE(<<, __VA_ARGS__)); \
+#define _CBOR_FIELDS_1(T, m) &T::m
+#define _CBOR_FIELDS_2(T, m, ...) \
+  &T::m, _CBOR_FIELDS_1(T, __VA_ARGS__)
+#define _CBOR_FIELDS_3(T, m, ...) \
+  &T::m, _CBOR_FIELDS_2(T, __VA_ARGS__)
+#define _CBOR_FIELDS_4(T, m, ...) \
+  &T::m, _CBOR_FIELDS_3(T, __VA_ARGS__)
+#define _CBOR_FIELDS_5(T, m, ...) \
+  &T::m, _CBOR_FIELDS_4(T, __VA_ARGS__)
+#define _CBOR_FIELDS_6(T, m, ...) \
+  &T::m, _CBOR_FIELDS_5(T, __VA_ARGS__)
+#define _CBOR_FIELDS_7(T, m, ...) \
+  &T::m, _CBOR_FIELDS_6(T, __VA_ARGS__)
+#define _CBOR_FIELDS_8(T, m, ...) \
+  &T::m, _CBOR_FIELDS_7(T, __VA_ARGS__)
+#define _CBOR_FIELDS_9(T, m, ...) \
+  &T::m, _CBOR_FIELDS_8(T, __VA_ARGS__)
+#define _CBOR_FIELDS_10(T, m, ...) \
+  &T::m, _CBOR_FIELDS_9(T, __VA_ARGS__)
+#define _CBOR_FIELDS_11(T, m, ...) \
+  &T::m, _CBOR_FIELDS_10(T, __VA_ARGS__)
+#define _CBOR_FIELDS_12(T, m, ...) \
+  &T::m, _CBOR_FIELDS_11(T, __VA_ARGS__)
+#define _CBOR_FIELDS_13(T, m, ...) \
+  &T::m, _CBOR_FIELDS_12(T, __VA_ARGS__)
+#define _CBOR_FIELDS(T, ...)     \
+  _CBOR_TUPLE_V(__VA_ARGS__,     \
+                _CBOR_FIELDS_13, \
+                _CBOR_FIELDS_12, \
+                _CBOR_FIELDS_11, \
+                _CBOR_FIELDS_10, \
+                _CBOR_FIELDS_9,  \
+                _CBOR_FIELDS_8,  \
+                _CBOR_FIELDS_7,  \
+                _CBOR_FIELDS_6,  \
+                _CBOR_FIELDS_5,  \
+                _CBOR_FIELDS_4,  \
+                _CBOR_FIELDS_3,  \
+                _CBOR_FIELDS_2,  \
+                _CBOR_FIELDS_1)  \
+  (T, __VA_ARGS__)
+
+#define _CBOR_TUPLE_SIZE(...) \
+  _CBOR_TUPLE_V(__VA_ARGS__, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1)
+
+/// Tuple header is written to stream directly, fields follow it
+#define CBOR_ENCODE_TUPLE(T, ...)                                       \
+  CBOR_ENCODE(T, t) {                                                   \
+    s.tuple(_CBOR_TUPLE_SIZE(__VA_ARGS__)) _CBOR_TUPLE(<<, __VA_ARGS__); \
+    return s;                                                           \
+  }
+
+/// Member pointers of tuple fields in encoding order, used by CborTupleView
+#define CBOR_TUPLE_FIELDS(T, ...)                         \
+  constexpr auto cborTupleFields(const T *) {             \
+    return std::make_tuple(_CBOR_FIELDS(T, __VA_ARGS__)); \
   }
 
 #define CBOR_TUPLE(T, ...)                 \
@@ -73,6 +128,7 @@
   CBOR_DECODE(T, t) {                      \
     s.list() _CBOR_TUPLE(>>, __VA_ARGS__); \
     return s;                              \
-  }
+  }                                        \
+  CBOR_TUPLE_FIELDS(T, __VA_ARGS__)
 
 #endif  // CPP_FILECOIN_STREAMS_ANNOTATION_HPP
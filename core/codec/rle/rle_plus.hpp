@@ -6,10 +6,15 @@
 #ifndef CODEC_RLE_PLUS_HPP
 #define CODEC_RLE_PLUS_HPP
 
+#include <limits>
+
 #include "common/outcome.hpp"
 #include "codec/rle/rle_plus_errors.hpp"
 #include "codec/rle/rle_plus_decoding_stream.hpp"
 #include "codec/rle/rle_plus_encoding_stream.hpp"
+#include "codec/rle/rle_plus_iterator.hpp"
+#include "codec/rle/rle_plus_reader.hpp"
+#include "codec/rle/rle_plus_writer.hpp"
 
 namespace fc::codec::rle {
   /**
@@ -21,9 +26,44 @@ namespace fc::codec::rle {
    */
   template <typename T, typename A>
   std::vector<uint8_t> encode(const std::set<T, A> &input) {
-    RLEPlusEncodingStream encoder;
-    encoder << input;
-    return encoder.data();
+    RlePlusWriter writer;
+    for (const auto &value : input) {
+      writer.append(static_cast<uint64_t>(value));
+    }
+    return writer.finish();
+  }
+
+  /**
+   * @brief RLE+ encode runs of set bits
+   * @param runs - sorted disjoint runs
+   * @return Encoded byte-vector
+   */
+  inline std::vector<uint8_t> encodeRuns(gsl::span<const Run> runs) {
+    RlePlusWriter writer;
+    for (const auto &run : runs) {
+      writer.append(run);
+    }
+    return writer.finish();
+  }
+
+  /**
+   * @brief RLE+ decode to runs of set bits, without expanding them
+   * @param input - data to decode
+   * @return Decoded runs in ascending order
+   */
+  inline outcome::result<std::vector<Run>> decodeRuns(
+      gsl::span<const uint8_t> input) {
+    std::vector<Run> runs;
+    RlePlusReader reader{input};
+    Run run;
+    while (true) {
+      OUTCOME_TRY(more, reader.next(run));
+      if (!more) {
+        break;
+      }
+      runs.push_back(run);
+    }
+    return runs;
   }
 
   /**
@@ -34,18 +74,26 @@ namespace fc::codec::rle {
    */
   template <typename T>
   outcome::result<std::set<T>> decode(gsl::span<const uint8_t> input) {
+    constexpr size_t max_size = OBJECT_MAX_SIZE / sizeof(T);
     std::set<T> data;
-    RLEPlusDecodingStream decoder(input);
-    try {
-      decoder >> data;
-    } catch (errors::VersionMismatch&) {
-      return RLEPlusDecodeError::VersionMismatch;
-    } catch (errors::IndexOutOfBound&) {
-      return RLEPlusDecodeError::DataIndexFailure;
-    } catch (errors::UnpackBytesOverflow&) {
-      return RLEPlusDecodeError::UnpackOverflow;
-    } catch (errors::MaxSizeExceed&) {
-      return RLEPlusDecodeError::MaxSizeExceed;
+    RlePlusReader reader{input};
+    Run run;
+    size_t size{};
+    while (true) {
+      OUTCOME_TRY(more, reader.next(run));
+      if (!more) {
+        break;
+      }
+      if (run.length > max_size - size) {
+        return RLEPlusDecodeError::MaxSizeExceed;
+      }
+      if (run.end() - 1 > std::numeric_limits<T>::max()) {
+        return RLEPlusDecodeError::UnpackOverflow;
+      }
+      size += run.length;
+      for (auto value = run.start; value != run.end(); ++value) {
+        data.emplace_hint(data.end(), static_cast<T>(value));
+      }
     }
     return data;
   }
@@ -0,0 +1,195 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_CODEC_RLE_RLE_PLUS_ITERATOR_HPP
+#define CPP_FILECOIN_CORE_CODEC_RLE_RLE_PLUS_ITERATOR_HPP
+
+#include <iterator>
+
+#include "codec/rle/rle_plus_reader.hpp"
+#include "common/outcome_throw.hpp"
+
+namespace fc::codec::rle {
+  /**
+   * @class Forward iterator over runs of set bits in RLE+ bytes, decoded
+   * lazily. Decode errors are thrown as std::system_error.
+   */
+  class RunIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Run;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Run *;
+    using reference = const Run &;
+
+    /// End iterator
+    RunIterator() = default;
+
+    /**
+     * @brief Iterator to first run
+     * @param data - RLE+ encoded bytes, must outlive iterator
+     */
+    explicit RunIterator(gsl::span<const uint8_t> data)
+        : reader_{data}, end_{false} {
+      ++*this;
+    }
+
+    const Run &operator*() const {
+      return run_;
+    }
+
+    const Run *operator->() const {
+      return &run_;
+    }
+
+    RunIterator &operator++() {
+      auto more = reader_.next(run_);
+      if (!more) {
+        outcome::raise(more.error());
+      }
+      end_ = !more.value();
+      return *this;
+    }
+
+    RunIterator operator++(int) {
+      auto copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    bool operator==(const RunIterator &other) const {
+      return end_ == other.end_ && (end_ || run_ == other.run_);
+    }
+
+    bool operator!=(const RunIterator &other) const {
+      return !(*this == other);
+    }
+
+   private:
+    RlePlusReader reader_{{}};
+    Run run_;
+    bool end_{true};
+  };
+
+  /**
+   * @class Forward iterator over set bits in RLE+ bytes, decoded lazily.
+   * Decode errors are thrown as std::system_error.
+   */
+  class ValueIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = uint64_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const uint64_t *;
+    using reference = uint64_t;
+
+    /// End iterator
+    ValueIterator() = default;
+
+    /**
+     * @brief Iterator to first set bit
+     * @param data - RLE+ encoded bytes, must outlive iterator
+     */
+    explicit ValueIterator(gsl::span<const uint8_t> data) : run_{data} {}
+
+    uint64_t operator*() const {
+      return run_->start + offset_;
+    }
+
+    ValueIterator &operator++() {
+      if (++offset_ == run_->length) {
+        ++run_;
+        offset_ = 0;
+      }
+      return *this;
+    }
+
+    ValueIterator operator++(int) {
+      auto copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    bool operator==(const ValueIterator &other) const {
+      return run_ == other.run_ && offset_ == other.offset_;
+    }
+
+    bool operator!=(const ValueIterator &other) const {
+      return !(*this == other);
+    }
+
+   private:
+    RunIterator run_;
+    uint64_t offset_{};
+  };
+
+  /**
+   * @class Range over RLE+ bytes without materialization
+   * @tparam Iterator - RunIterator or ValueIterator
+   */
+  template <typename Iterator>
+  class RlePlusRange {
+   public:
+    /// @param data - RLE+ encoded bytes, must outlive range
+    explicit RlePlusRange(gsl::span<const uint8_t> data) : data_{data} {}
+
+    Iterator begin() const {
+      return Iterator{data_};
+    }
+
+    Iterator end() const {
+      return {};
+    }
+
+   private:
+    gsl::span<const uint8_t> data_;
+  };
+
+  /// Lazily decoded runs of set bits
+  using RlePlusRuns = RlePlusRange<RunIterator>;
+  /// Lazily decoded set bits
+  using RlePlusValues = RlePlusRange<ValueIterator>;
+
+  /**
+   * @brief Count set bits in one pass without allocation
+   * @param data - RLE+ encoded bytes
+   * @return Count of set bits
+   */
+  inline outcome::result<uint64_t> count(gsl::span<const uint8_t> data) {
+    RlePlusReader reader{data};
+    Run run;
+    uint64_t total{};
+    while (true) {
+      OUTCOME_TRY(more, reader.next(run));
+      if (!more) {
+        return total;
+      }
+      total += run.length;
+    }
+  }
+
+  /**
+   * @brief Check whether bit is set, decoding stops at first run after it
+   * @param data - RLE+ encoded bytes
+   * @param value - index of bit
+   * @return true if bit is set
+   */
+  inline outcome::result<bool> contains(gsl::span<const uint8_t> data,
+                                        uint64_t value) {
+    RlePlusReader reader{data};
+    Run run;
+    while (true) {
+      OUTCOME_TRY(more, reader.next(run));
+      if (!more || run.start > value) {
+        return false;
+      }
+      if (value < run.end()) {
+        return true;
+      }
+    }
+  }
+}  // namespace fc::codec::rle
+
+#endif  // CPP_FILECOIN_CORE_CODEC_RLE_RLE_PLUS_ITERATOR_HPP
@@ -0,0 +1,108 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "codec/rle/rle_plus_reader.hpp"
+
+#include <cstring>
+#include <limits>
+
+#include <boost/endian/conversion.hpp>
+
+#include "codec/rle/rle_plus_config.hpp"
+
+namespace fc::codec::rle {
+  RlePlusReader::RlePlusReader(gsl::span<const uint8_t> data) : data_{data} {
+    for (auto i = data_.size(); i > 0; --i) {
+      uint8_t byte = data_[i - 1];
+      if (byte != 0) {
+        end_ = (i - 1) * BYTE_BITS_COUNT;
+        for (; byte != 0; byte >>= 1) {
+          ++end_;
+        }
+        break;
+      }
+    }
+  }
+
+  outcome::result<bool> RlePlusReader::next(Run &run) {
+    if (!started_) {
+      auto header = peek();
+      if (data_.empty() || (header & 0x3) != 0) {
+        return RLEPlusDecodeError::VersionMismatch;
+      }
+      value_ = (header & 0x4) != 0;
+      bit_ = 3;
+      started_ = true;
+    }
+    while (bit_ < end_) {
+      OUTCOME_TRY(length, readLength());
+      if (length == 0
+          || length > std::numeric_limits<uint64_t>::max() - next_) {
+        return RLEPlusDecodeError::DataIndexFailure;
+      }
+      auto start = next_;
+      auto value = value_;
+      next_ += length;
+      value_ = !value_;
+      if (value) {
+        run = {start, length};
+        return true;
+      }
+    }
+    return false;
+  }
+
+  uint64_t RlePlusReader::peek() const {
+    const size_t size = data_.size();
+    auto byte = bit_ / BYTE_BITS_COUNT;
+    uint64_t word{};
+    if (byte + sizeof(word) <= size) {
+      std::memcpy(&word, data_.data() + byte, sizeof(word));
+      boost::endian::little_to_native_inplace(word);
+    } else {
+      for (auto i = byte; i < size; ++i) {
+        word |= static_cast<uint64_t>(data_[i]) << ((i - byte) * 8);
+      }
+    }
+    return word >> (bit_ % BYTE_BITS_COUNT);
+  }
+
+  outcome::result<uint64_t> RlePlusReader::readLength() {
+    const size_t size = data_.size() * BYTE_BITS_COUNT;
+    auto word = peek();
+    uint64_t length{};
+    if ((word & 0x1) != 0) {
+      // single block "1"
+      bit_ += 1;
+      length = 1;
+    } else if ((word & 0x2) != 0) {
+      // small block "01" and 4 bits of length
+      bit_ += 2 + SMALL_BLOCK_LENGTH;
+      length = (word >> 2) & ((1 << SMALL_BLOCK_LENGTH) - 1);
+    } else {
+      // long block "00" and varint length
+      bit_ += 2;
+      for (size_t shift = 0;; shift += PACK_BYTE_SHIFT) {
+        if (bit_ + BYTE_BITS_COUNT > size) {
+          return RLEPlusDecodeError::DataIndexFailure;
+        }
+        uint64_t byte = peek() & 0xFF;
+        bit_ += BYTE_BITS_COUNT;
+        auto slice = byte & UNPACK_BYTE_MASK;
+        if (shift >= 64 || (slice << shift) >> shift != slice) {
+          return RLEPlusDecodeError::UnpackOverflow;
+        }
+        length |= slice << shift;
+        if ((byte & BYTE_SLICE_VALUE) == 0) {
+          break;
+        }
+      }
+    }
+    if (bit_ > size) {
+      return RLEPlusDecodeError::DataIndexFailure;
+    }
+    return length;
+  }
+}  // namespace fc::codec::rle
@@ -0,0 +1,51 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_CODEC_RLE_RLE_PLUS_READER_HPP
+#define CPP_FILECOIN_CORE_CODEC_RLE_RLE_PLUS_READER_HPP
+
+#include <gsl/span>
+
+#include "codec/rle/rle_plus_errors.hpp"
+#include "codec/rle/rle_plus_run.hpp"
+
+namespace fc::codec::rle {
+  /**
+   * @class Reads runs of set bits from RLE+ bytes. Bits are extracted from
+   * 64-bit little-endian words loaded directly from input, so blocks are
+   * decoded with a few shifts and masks instead of bit by bit.
+   */
+  class RlePlusReader {
+   public:
+    /**
+     * @brief Constructor
+     * @param data - RLE+ encoded bytes, must outlive reader
+     */
+    explicit RlePlusReader(gsl::span<const uint8_t> data);
+
+    /**
+     * @brief Read next run of set bits
+     * @param run - run to fill
+     * @return true if run was read, false if there are no more runs
+     */
+    outcome::result<bool> next(Run &run);
+
+   private:
+    /// Load at least 57 bits starting at current bit, zeros past input end
+    uint64_t peek() const;
+
+    /// Read length of next block
+    outcome::result<uint64_t> readLength();
+
+    gsl::span<const uint8_t> data_; /**< Encoded data */
+    size_t bit_{};                  /**< Current bit index */
+    size_t end_{};    /**< Index after last set bit, rest is padding */
+    uint64_t next_{}; /**< Index of first bit of next block */
+    bool value_{};    /**< Polarity of next block */
+    bool started_{};  /**< Header was read */
+  };
+}  // namespace fc::codec::rle
+
+#endif  // CPP_FILECOIN_CORE_CODEC_RLE_RLE_PLUS_READER_HPP
@@ -0,0 +1,34 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_CODEC_RLE_RLE_PLUS_RUN_HPP
+#define CPP_FILECOIN_CORE_CODEC_RLE_RLE_PLUS_RUN_HPP
+
+#include <cstdint>
+
+namespace fc::codec::rle {
+  /**
+   * @struct Run of consecutive set bits [start, start + length)
+   */
+  struct Run {
+    uint64_t start{};
+    uint64_t length{};
+
+    /// Index after last bit of run
+    uint64_t end() const {
+      return start + length;
+    }
+
+    bool operator==(const Run &other) const {
+      return start == other.start && length == other.length;
+    }
+
+    bool operator!=(const Run &other) const {
+      return !(*this == other);
+    }
+  };
+}  // namespace fc::codec::rle
+
+#endif  // CPP_FILECOIN_CORE_CODEC_RLE_RLE_PLUS_RUN_HPP
@@ -0,0 +1,83 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "codec/rle/rle_plus_writer.hpp"
+
+#include <cassert>
+
+#include "codec/rle/rle_plus_config.hpp"
+
+namespace fc::codec::rle {
+  void RlePlusWriter::append(const Run &run) {
+    if (run.length == 0) {
+      return;
+    }
+    if (run_.length != 0 && run_.end() == run.start) {
+      run_.length += run.length;
+      return;
+    }
+    assert(run_.length == 0 || run_.end() < run.start);
+    flush();
+    run_ = run;
+  }
+
+  std::vector<uint8_t> RlePlusWriter::finish() {
+    flush();
+    start(false);
+    if (bits_count_ != 0) {
+      bytes_.push_back(static_cast<uint8_t>(bits_));
+    }
+    auto bytes = std::move(bytes_);
+    *this = RlePlusWriter{};
+    return bytes;
+  }
+
+  void RlePlusWriter::flush() {
+    if (run_.length == 0) {
+      return;
+    }
+    start(run_.start == 0);
+    if (run_.start != end_) {
+      pushLength(run_.start - end_);
+    }
+    pushLength(run_.length);
+    end_ = run_.end();
+    run_ = {};
+  }
+
+  void RlePlusWriter::start(bool flag) {
+    if (!started_) {
+      // version "00" and polarity of first block
+      pushBits(flag ? 0x4 : 0x0, 3);
+      started_ = true;
+    }
+  }
+
+  void RlePlusWriter::pushLength(uint64_t length) {
+    if (length == 1) {
+      pushBits(0x1, 1);
+    } else if (length < LONG_BLOCK_VALUE) {
+      pushBits(0x2 | (length << 2), 2 + SMALL_BLOCK_LENGTH);
+    } else {
+      pushBits(0x0, 2);
+      while (length >= BYTE_SLICE_VALUE) {
+        pushBits((length & UNPACK_BYTE_MASK) | BYTE_SLICE_VALUE,
+                 BYTE_BITS_COUNT);
+        length >>= PACK_BYTE_SHIFT;
+      }
+      pushBits(length, BYTE_BITS_COUNT);
+    }
+  }
+
+  void RlePlusWriter::pushBits(uint64_t bits, size_t count) {
+    bits_ |= bits << bits_count_;
+    bits_count_ += count;
+    while (bits_count_ >= BYTE_BITS_COUNT) {
+      bytes_.push_back(static_cast<uint8_t>(bits_));
+      bits_ >>= BYTE_BITS_COUNT;
+      bits_count_ -= BYTE_BITS_COUNT;
+    }
+  }
+}  // namespace fc::codec::rle
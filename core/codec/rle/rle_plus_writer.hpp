@@ -0,0 +1,65 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_CODEC_RLE_RLE_PLUS_WRITER_HPP
+#define CPP_FILECOIN_CORE_CODEC_RLE_RLE_PLUS_WRITER_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "codec/rle/rle_plus_run.hpp"
+
+namespace fc::codec::rle {
+  /**
+   * @class Writes RLE+ bytes from runs of set bits. Blocks are collected in
+   * 64-bit accumulator and written to output byte by byte, without
+   * intermediate bit vector.
+   */
+  class RlePlusWriter {
+   public:
+    /**
+     * @brief Append run of set bits
+     * @param run - run starting at or after end of previous run, adjacent
+     * runs are merged
+     */
+    void append(const Run &run);
+
+    /**
+     * @brief Append set bit
+     * @param value - index at or after end of previous run
+     */
+    void append(uint64_t value) {
+      append(Run{value, 1});
+    }
+
+    /**
+     * @brief Finish encoding, writer is left empty
+     * @return Encoded bytes
+     */
+    std::vector<uint8_t> finish();
+
+   private:
+    /// Write pending run with preceding gap
+    void flush();
+
+    /// Write header on first block
+    void start(bool flag);
+
+    /// Write block with length of run
+    void pushLength(uint64_t length);
+
+    /// Write low count bits of value, count must not exceed 56
+    void pushBits(uint64_t bits, size_t count);
+
+    std::vector<uint8_t> bytes_; /**< Complete bytes */
+    uint64_t bits_{};            /**< Accumulated bits */
+    size_t bits_count_{};        /**< Count of accumulated bits */
+    Run run_{};                  /**< Pending run, merged with adjacent */
+    uint64_t end_{};             /**< End of last written run */
+    bool started_{};             /**< Header was written */
+  };
+}  // namespace fc::codec::rle
+
+#endif  // CPP_FILECOIN_CORE_CODEC_RLE_RLE_PLUS_WRITER_HPP
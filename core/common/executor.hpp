@@ -0,0 +1,80 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_COMMON_EXECUTOR_HPP
+#define CPP_FILECOIN_CORE_COMMON_EXECUTOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace fc::common {
+
+  /**
+   * Schedules task for asynchronous execution, e.g. posts it to thread pool.
+   * Empty executor means tasks are run by calling thread.
+   */
+  using Executor = std::function<void(std::function<void()>)>;
+
+  /**
+   * Run tasks concurrently using executor and wait until all of them are
+   * complete. Calling thread executes tasks too, so completion doesn't depend
+   * on executor having free threads. If tasks throw, first exception is
+   * rethrown after all tasks are complete.
+   * @param executor - executor to schedule helpers on, may be empty
+   * @param tasks - independent tasks
+   */
+  inline void runTasks(const Executor &executor,
+                       std::vector<std::function<void()>> tasks) {
+    struct State {
+      std::vector<std::function<void()>> tasks;
+      std::atomic<size_t> next{};
+      size_t done{};
+      std::exception_ptr error;
+      std::mutex mutex;
+      std::condition_variable condition;
+    };
+    auto state = std::make_shared<State>();
+    state->tasks = std::move(tasks);
+    auto work = [](State &state) {
+      size_t done = 0;
+      for (auto i = state.next++; i < state.tasks.size(); i = state.next++) {
+        try {
+          state.tasks[i]();
+        } catch (...) {
+          std::lock_guard lock{state.mutex};
+          if (!state.error) {
+            state.error = std::current_exception();
+          }
+        }
+        ++done;
+      }
+      if (done != 0) {
+        std::lock_guard lock{state.mutex};
+        state.done += done;
+        state.condition.notify_all();
+      }
+    };
+    if (executor) {
+      for (size_t i = 1; i < state->tasks.size(); ++i) {
+        executor([state, work] { work(*state); });
+      }
+    }
+    work(*state);
+    std::unique_lock lock{state->mutex};
+    state->condition.wait(
+        lock, [&state] { return state->done == state->tasks.size(); });
+    if (state->error) {
+      std::rethrow_exception(state->error);
+    }
+  }
+
+}  // namespace fc::common
+
+#endif  // CPP_FILECOIN_CORE_COMMON_EXECUTOR_HPP
@@ -0,0 +1,124 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_COMMON_FLUSH_WRITES_HPP
+#define CPP_FILECOIN_CORE_COMMON_FLUSH_WRITES_HPP
+
+#include <boost/optional.hpp>
+
+#include "common/buffer.hpp"
+#include "common/executor.hpp"
+#include "common/outcome.hpp"
+
+namespace fc::common {
+
+  /**
+   * Nodes of tree encoded by flush and pending write to storage, children
+   * before parents. Encoding sets key of node, nodes are kept until writes
+   * succeed, so failed flush resets keys and tree stays modified.
+   * @tparam Key - key of encoded node, e.g. CID
+   * @tparam Node - node with optional `cid` member holding its key
+   */
+  template <typename Key, typename Node>
+  class FlushWrites {
+   public:
+    /**
+     * Add encoded node, its key must already be set
+     * @param key - key of node
+     * @param bytes - encoded node
+     * @param node - node to unflush if write does not happen
+     */
+    void add(Key key, Buffer bytes, Node &node) {
+      writes_.push_back({std::move(key), std::move(bytes), &node});
+    }
+
+    /// Count of encoded nodes
+    size_t size() const {
+      return writes_.size();
+    }
+
+    /**
+     * Reset key of nodes whose writes from begin did not happen, so next
+     * flush encodes them again
+     * @param begin - index of first node to reset
+     */
+    void unflush(size_t begin = 0) {
+      for (auto i = begin; i < writes_.size(); ++i) {
+        writes_[i].node->cid = boost::none;
+      }
+    }
+
+    /**
+     * @brief Encode subtrees concurrently, each child is encoded by
+     * flush(child, writes) into own writes. Writes of all children are
+     * appended in order of children even if some of them fail, so failed
+     * flush can unflush them. Does nothing without executor or with less than
+     * two children, remaining nodes are encoded by calling thread afterwards.
+     * @param executor - executor to encode children with
+     * @param children - independent subtrees
+     * @param flush - encodes subtree, called concurrently
+     * @return first error of children
+     */
+    template <typename Child, typename Flush>
+    outcome::result<void> flushConcurrently(
+        const Executor &executor,
+        const std::vector<Child *> &children,
+        const Flush &flush) {
+      if (!executor || children.size() < 2) {
+        return outcome::success();
+      }
+      std::vector<FlushWrites> child_writes(children.size());
+      std::vector<outcome::result<void>> results(children.size(),
+                                                 outcome::success());
+      std::vector<std::function<void()>> tasks;
+      for (size_t i = 0; i < children.size(); ++i) {
+        tasks.emplace_back([&, i] {
+          results[i] = flush(*children[i], child_writes[i]);
+        });
+      }
+      runTasks(executor, std::move(tasks));
+      for (auto &child : child_writes) {
+        writes_.insert(writes_.end(),
+                       std::make_move_iterator(child.writes_.begin()),
+                       std::make_move_iterator(child.writes_.end()));
+      }
+      for (auto &result : results) {
+        OUTCOME_TRY(result);
+      }
+      return outcome::success();
+    }
+
+    /**
+     * @brief Write encoded nodes in order they were added. Storage is
+     * accessed only by calling thread. If write fails, nodes not written yet
+     * are unflushed.
+     * @param set - stores encoded node by key
+     * @return first error
+     */
+    template <typename Set>
+    outcome::result<void> write(const Set &set) {
+      for (size_t i = 0; i < writes_.size(); ++i) {
+        auto written = set(writes_[i].key, std::move(writes_[i].bytes));
+        if (!written) {
+          unflush(i);
+          return written.error();
+        }
+      }
+      return outcome::success();
+    }
+
+   private:
+    struct Write {
+      Key key;
+      Buffer bytes;
+      Node *node;
+    };
+
+    std::vector<Write> writes_;
+  };
+
+}  // namespace fc::common
+
+#endif  // CPP_FILECOIN_CORE_COMMON_FLUSH_WRITES_HPP
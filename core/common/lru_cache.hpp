@@ -0,0 +1,140 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_COMMON_LRU_CACHE_HPP
+#define CPP_FILECOIN_CORE_COMMON_LRU_CACHE_HPP
+
+#include <list>
+#include <map>
+#include <mutex>
+
+#include <boost/optional.hpp>
+
+namespace fc::common {
+
+  /**
+   * Thread-safe least recently used cache bounded by total size of entries.
+   * Size of each entry is supplied by caller (e.g. encoded size in bytes).
+   * @tparam Key - ordered key type
+   * @tparam Value - value type, copied out on lookup
+   */
+  template <typename Key, typename Value>
+  class LruCache {
+   public:
+    /// Cache counters
+    struct Stats {
+      size_t hits{};
+      size_t misses{};
+      size_t evictions{};
+      /// Count of entries currently cached
+      size_t entries{};
+      /// Total size of entries currently cached
+      size_t size{};
+    };
+
+    /**
+     * @param max_size - max total size of entries
+     */
+    explicit LruCache(size_t max_size) : max_size_{max_size} {}
+
+    /**
+     * Get value by key and mark it as recently used
+     * @param key - key to find
+     * @return value or none
+     */
+    boost::optional<Value> get(const Key &key) {
+      std::lock_guard lock{mutex_};
+      auto it = index_.find(key);
+      if (it == index_.end()) {
+        ++stats_.misses;
+        return boost::none;
+      }
+      ++stats_.hits;
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return it->second->value;
+    }
+
+    /**
+     * Insert or replace value, evicting least recently used entries to fit.
+     * Entries larger than max size are not cached.
+     * @param key - key to associate
+     * @param value - value to store
+     * @param size - size of value
+     * @return true if value was cached
+     */
+    bool put(const Key &key, Value value, size_t size) {
+      std::lock_guard lock{mutex_};
+      auto it = index_.find(key);
+      if (it != index_.end()) {
+        stats_.size -= it->second->size;
+        entries_.erase(it->second);
+        index_.erase(it);
+      }
+      if (size > max_size_) {
+        stats_.entries = index_.size();
+        return false;
+      }
+      while (stats_.size + size > max_size_) {
+        auto &last = entries_.back();
+        stats_.size -= last.size;
+        index_.erase(last.key);
+        entries_.pop_back();
+        ++stats_.evictions;
+      }
+      entries_.push_front({key, std::move(value), size});
+      index_.emplace(key, entries_.begin());
+      stats_.size += size;
+      stats_.entries = index_.size();
+      return true;
+    }
+
+    /**
+     * Remove entry if it exists, not counted as eviction
+     * @param key - key to remove
+     */
+    void erase(const Key &key) {
+      std::lock_guard lock{mutex_};
+      auto it = index_.find(key);
+      if (it == index_.end()) {
+        return;
+      }
+      stats_.size -= it->second->size;
+      entries_.erase(it->second);
+      index_.erase(it);
+      stats_.entries = index_.size();
+    }
+
+    /// Remove all entries, counters are preserved
+    void clear() {
+      std::lock_guard lock{mutex_};
+      index_.clear();
+      entries_.clear();
+      stats_.entries = 0;
+      stats_.size = 0;
+    }
+
+    /// Get counters snapshot
+    Stats stats() const {
+      std::lock_guard lock{mutex_};
+      return stats_;
+    }
+
+   private:
+    struct Entry {
+      Key key;
+      Value value;
+      size_t size;
+    };
+
+    mutable std::mutex mutex_;
+    size_t max_size_;
+    std::list<Entry> entries_;
+    std::map<Key, typename std::list<Entry>::iterator> index_;
+    Stats stats_;
+  };
+
+}  // namespace fc::common
+
+#endif  // CPP_FILECOIN_CORE_COMMON_LRU_CACHE_HPP
@@ -17,11 +17,13 @@ using fc::primitives::address::encodeToByteString;
 using fc::storage::hamt::HamtError;
 using fc::storage::hamt::Value;
 
-PowerTableHamt::PowerTableHamt(Hamt hamt) : power_table_{std::move(hamt)} {}
+PowerTableHamt::PowerTableHamt(Hamt hamt)
+    : max_power_{std::make_shared<MaxAggregate<Power>>()},
+      power_table_{std::move(hamt), {max_power_}} {}
 
 fc::outcome::result<Power> PowerTableHamt::getMinerPower(
     const Address &address) const {
-  auto result = power_table_.getCbor<Power>(encodeToByteString(address));
+  auto result = power_table_.get(encodeToByteString(address));
   if (!result && result.error() == HamtError::NOT_FOUND) {
     return outcome::failure(PowerTableError::NO_SUCH_MINER);
   }
@@ -31,7 +33,7 @@ fc::outcome::result<Power> PowerTableHamt::getMinerPower(
 fc::outcome::result<void> PowerTableHamt::setMinerPower(const Address &address,
                                                         Power power_amount) {
   if (power_amount < 0) return PowerTableError::NEGATIVE_POWER;
-  return power_table_.setCbor(encodeToByteString(address), power_amount);
+  return power_table_.set(encodeToByteString(address), power_amount);
 }
 
 fc::outcome::result<void> PowerTableHamt::removeMiner(const Address &address) {
@@ -43,25 +45,12 @@ fc::outcome::result<void> PowerTableHamt::removeMiner(const Address &address) {
 }
 
 fc::outcome::result<size_t> PowerTableHamt::getSize() const {
-  size_t n = 0;
-  Hamt::Visitor counter{[&n](auto k, auto v) {
-    ++n;
-    return fc::outcome::success();
-  }};
-  OUTCOME_TRY(power_table_.visit(counter));
-  return n;
+  return power_table_.size();
 }
 
 fc::outcome::result<Power> PowerTableHamt::getMaxPower() const {
-  Power max = 0;
-  Hamt::Visitor max_visitor{
-      [&max](auto k, auto v) -> fc::outcome::result<void> {
-        OUTCOME_TRY(power, codec::cbor::decode<Power>(v));
-        if (max < power) max = power;
-        return fc::outcome::success();
-      }};
-  OUTCOME_TRY(power_table_.visit(max_visitor));
-  return max;
+  OUTCOME_TRY(power_table_.load());
+  return max_power_->value().value_or(0);
 }
 
 fc::outcome::result<std::vector<Address>> PowerTableHamt::getMiners() const {
@@ -72,6 +61,6 @@ fc::outcome::result<std::vector<Address>> PowerTableHamt::getMiners() const {
         miners.push_back(address);
         return fc::outcome::success();
       }};
-  OUTCOME_TRY(power_table_.visit(max_visitor));
+  OUTCOME_TRY(power_table_.hamt().visit(max_visitor));
   return miners;
 }
@@ -7,14 +7,17 @@
 #define CPP_FILECOIN_POWER_POWER_TABLE_HAMT_HPP
 
 #include "power/power_table.hpp"
-#include "storage/hamt/hamt.hpp"
+#include "storage/hamt/aggregated_hamt.hpp"
 
 namespace fc::power {
 
+  using storage::hamt::AggregatedHamt;
   using storage::hamt::Hamt;
+  using storage::hamt::MaxAggregate;
 
   /**
-   * @class PowerTableHamt - HAMT-based implementation of PowerTable
+   * @class PowerTableHamt - HAMT-based implementation of PowerTable.
+   * Not copyable, max power aggregate belongs to single table.
    */
   class PowerTableHamt : public PowerTable {
    public:
@@ -45,6 +48,8 @@ namespace fc::power {
     outcome::result<std::vector<Address>> getMiners() const override;
 
    private:
+    /// Max power, maintained by power_table_
+    std::shared_ptr<MaxAggregate<Power>> max_power_;
     /**
      * TODO (a.chernyshov) HAMT getter is not constant due to it uses cache.
      * It is a common example to use mutable field in HAMT.
@@ -52,8 +57,10 @@ namespace fc::power {
      * correctness the power_table_ field is marked as mutable.
      *
      * Remove mutable keyword after HAMT getter has const qualifier.
+     *
+     * Size and max power are maintained on updates, so queries are O(1).
      */
-    mutable Hamt power_table_;
+    mutable AggregatedHamt<Power> power_table_;
   };
 
 }  // namespace fc::power
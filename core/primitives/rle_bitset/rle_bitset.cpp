@@ -0,0 +1,153 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/rle_bitset/rle_bitset.hpp"
+
+#include <algorithm>
+
+namespace fc::primitives {
+  namespace {
+    /// Append run to sorted runs, merging it with last run if they touch
+    void append(RleBitset::Runs &runs, const RleBitset::Run &run) {
+      if (!runs.empty() && runs.back().end() >= run.start) {
+        auto &last = runs.back();
+        last.length = std::max(last.end(), run.end()) - last.start;
+      } else {
+        runs.push_back(run);
+      }
+    }
+
+    /// Find first run ending after value
+    template <typename Runs>
+    auto findRun(Runs &runs, uint64_t value) {
+      return std::upper_bound(
+          runs.begin(), runs.end(), value, [](auto value, auto &run) {
+            return value < run.end();
+          });
+    }
+  }  // namespace
+
+  RleBitset::RleBitset(std::initializer_list<uint64_t> values)
+      : RleBitset(values.begin(), values.end()) {}
+
+  RleBitset RleBitset::fromRuns(Runs runs) {
+    RleBitset set;
+    set.runs_ = std::move(runs);
+    return set;
+  }
+
+  uint64_t RleBitset::size() const {
+    uint64_t size{};
+    for (const auto &run : runs_) {
+      size += run.length;
+    }
+    return size;
+  }
+
+  bool RleBitset::contains(uint64_t value) const {
+    auto it = findRun(runs_, value);
+    return it != runs_.end() && it->start <= value;
+  }
+
+  bool RleBitset::insert(uint64_t value) {
+    auto it = findRun(runs_, value);
+    if (it != runs_.end() && it->start <= value) {
+      return false;
+    }
+    auto joins_prev = it != runs_.begin() && std::prev(it)->end() == value;
+    auto joins_next = it != runs_.end() && it->start == value + 1;
+    if (joins_prev && joins_next) {
+      std::prev(it)->length += 1 + it->length;
+      runs_.erase(it);
+    } else if (joins_prev) {
+      ++std::prev(it)->length;
+    } else if (joins_next) {
+      --it->start;
+      ++it->length;
+    } else {
+      runs_.insert(it, Run{value, 1});
+    }
+    return true;
+  }
+
+  bool RleBitset::erase(uint64_t value) {
+    auto it = findRun(runs_, value);
+    if (it == runs_.end() || it->start > value) {
+      return false;
+    }
+    if (it->length == 1) {
+      runs_.erase(it);
+    } else if (value == it->start) {
+      ++it->start;
+      --it->length;
+    } else if (value == it->end() - 1) {
+      --it->length;
+    } else {
+      Run tail{value + 1, it->end() - value - 1};
+      it->length = value - it->start;
+      runs_.insert(std::next(it), tail);
+    }
+    return true;
+  }
+
+  RleBitset RleBitset::operator|(const RleBitset &other) const {
+    RleBitset result;
+    result.runs_.reserve(runs_.size() + other.runs_.size());
+    auto a = runs_.begin();
+    auto b = other.runs_.begin();
+    while (a != runs_.end() || b != other.runs_.end()) {
+      if (b == other.runs_.end()
+          || (a != runs_.end() && a->start < b->start)) {
+        append(result.runs_, *a++);
+      } else {
+        append(result.runs_, *b++);
+      }
+    }
+    return result;
+  }
+
+  RleBitset RleBitset::operator&(const RleBitset &other) const {
+    RleBitset result;
+    auto a = runs_.begin();
+    auto b = other.runs_.begin();
+    while (a != runs_.end() && b != other.runs_.end()) {
+      auto start = std::max(a->start, b->start);
+      auto end = std::min(a->end(), b->end());
+      if (start < end) {
+        result.runs_.push_back({start, end - start});
+      }
+      if (a->end() < b->end()) {
+        ++a;
+      } else {
+        ++b;
+      }
+    }
+    return result;
+  }
+
+  RleBitset RleBitset::operator-(const RleBitset &other) const {
+    RleBitset result;
+    auto b = other.runs_.begin();
+    for (auto run : runs_) {
+      while (b != other.runs_.end() && b->end() <= run.start) {
+        ++b;
+      }
+      for (auto c = b; c != other.runs_.end() && c->start < run.end(); ++c) {
+        if (c->start > run.start) {
+          result.runs_.push_back({run.start, c->start - run.start});
+        }
+        if (c->end() >= run.end()) {
+          run.length = 0;
+          break;
+        }
+        run = {c->end(), run.end() - c->end()};
+      }
+      if (run.length != 0) {
+        result.runs_.push_back(run);
+      }
+    }
+    return result;
+  }
+}  // namespace fc::primitives
@@ -6,28 +6,160 @@
 #ifndef CPP_FILECOIN_CORE_PRIMITIVES_RLE_BITSET_RLE_BITSET_HPP
 #define CPP_FILECOIN_CORE_PRIMITIVES_RLE_BITSET_RLE_BITSET_HPP
 
-#include <set>
+#include <iterator>
+#include <vector>
 
 #include "codec/cbor/streams_annotation.hpp"
 #include "codec/rle/rle_plus.hpp"
 #include "common/outcome_throw.hpp"
 
 namespace fc::primitives {
-  struct RleBitset : public std::set<uint64_t> {
-    using set::set;
+  /**
+   * Set of integers stored as sorted runs of consecutive values, like its
+   * RLE+ encoding. Memory and set operations cost is proportional to count
+   * of runs, not count of values.
+   */
+  class RleBitset {
+   public:
+    using Run = codec::rle::Run;
+    using Runs = std::vector<Run>;
+    using value_type = uint64_t;
 
-    inline RleBitset(set &&s) : set{s} {}
+    /// Forward iterator over values in ascending order
+    class const_iterator {
+     public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = uint64_t;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const uint64_t *;
+      using reference = uint64_t;
+
+      const_iterator() = default;
+      const_iterator(Runs::const_iterator run, uint64_t offset)
+          : run_{run}, offset_{offset} {}
+
+      uint64_t operator*() const {
+        return run_->start + offset_;
+      }
+
+      const_iterator &operator++() {
+        if (++offset_ == run_->length) {
+          ++run_;
+          offset_ = 0;
+        }
+        return *this;
+      }
+
+      const_iterator operator++(int) {
+        auto copy = *this;
+        ++*this;
+        return copy;
+      }
+
+      bool operator==(const const_iterator &other) const {
+        return run_ == other.run_ && offset_ == other.offset_;
+      }
+
+      bool operator!=(const const_iterator &other) const {
+        return !(*this == other);
+      }
+
+     private:
+      Runs::const_iterator run_;
+      uint64_t offset_{};
+    };
+    using iterator = const_iterator;
+
+    RleBitset() = default;
+    RleBitset(std::initializer_list<uint64_t> values);
+
+    /// Construct from values in any order
+    template <typename It>
+    RleBitset(It begin, It end) {
+      for (; begin != end; ++begin) {
+        insert(*begin);
+      }
+    }
+
+    /**
+     * Construct from runs
+     * @param runs - sorted, disjoint and non-adjacent non-empty runs
+     */
+    static RleBitset fromRuns(Runs runs);
+
+    /// Runs of values in ascending order
+    const Runs &runs() const {
+      return runs_;
+    }
+
+    bool empty() const {
+      return runs_.empty();
+    }
+
+    /// Count of values, O(runs)
+    uint64_t size() const;
+
+    /// Check whether value is in set, O(log runs)
+    bool contains(uint64_t value) const;
+
+    /// Add value, returns false if it was in set
+    bool insert(uint64_t value);
+
+    /// Remove value, returns false if it was not in set
+    bool erase(uint64_t value);
+
+    void clear() {
+      runs_.clear();
+    }
+
+    const_iterator begin() const {
+      return {runs_.begin(), 0};
+    }
+
+    const_iterator end() const {
+      return {runs_.end(), 0};
+    }
+
+    /// Union, O(runs)
+    RleBitset operator|(const RleBitset &other) const;
+    /// Intersection, O(runs)
+    RleBitset operator&(const RleBitset &other) const;
+    /// Difference, O(runs)
+    RleBitset operator-(const RleBitset &other) const;
+
+    RleBitset &operator|=(const RleBitset &other) {
+      return *this = *this | other;
+    }
+
+    RleBitset &operator&=(const RleBitset &other) {
+      return *this = *this & other;
+    }
+
+    RleBitset &operator-=(const RleBitset &other) {
+      return *this = *this - other;
+    }
+
+    bool operator==(const RleBitset &other) const {
+      return runs_ == other.runs_;
+    }
+
+    bool operator!=(const RleBitset &other) const {
+      return !(*this == other);
+    }
+
+   private:
+    Runs runs_;
   };
 
   CBOR_ENCODE(RleBitset, set) {
-    return s << codec::rle::encode(set);
+    return s << codec::rle::encodeRuns(set.runs());
   }
 
   CBOR_DECODE(RleBitset, set) {
-    std::vector<uint8_t> rle;
+    gsl::span<const uint8_t> rle;
     s >> rle;
-    OUTCOME_EXCEPT(decoded, codec::rle::decode<RleBitset::value_type>(rle));
-    set = RleBitset{std::move(decoded)};
+    OUTCOME_EXCEPT(runs, codec::rle::decodeRuns(rle));
+    set = RleBitset::fromRuns(std::move(runs));
     return s;
   }
 }  // namespace fc::primitives
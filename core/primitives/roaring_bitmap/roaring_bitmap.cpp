@@ -0,0 +1,417 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/roaring_bitmap/roaring_bitmap.hpp"
+
+#include <algorithm>
+#include <bitset>
+
+namespace fc::primitives {
+  namespace {
+    using Container = RoaringBitmap::Container;
+    constexpr auto kWords = RoaringBitmap::kWords;
+    constexpr auto kArrayMax = RoaringBitmap::kArrayMax;
+    constexpr uint64_t kAllOnes = ~uint64_t{0};
+
+    uint64_t popcount(uint64_t word) {
+      return std::bitset<64>{word}.count();
+    }
+
+    /// Count of trailing zeros, 64 for zero word
+    uint64_t countTrailingZeros(uint64_t word) {
+      return popcount((word & (~word + 1)) - 1);
+    }
+
+    /// Check whether low bits are in bitmap words
+    bool testBit(const std::vector<uint64_t> &words, uint16_t low) {
+      return (words[low / 64] >> (low % 64)) & 1;
+    }
+
+    void toBitmap(Container &container) {
+      container.words.assign(kWords, 0);
+      for (auto low : container.array) {
+        container.words[low / 64] |= uint64_t{1} << (low % 64);
+      }
+      container.array.clear();
+      container.array.shrink_to_fit();
+    }
+
+    /// Use array if cardinality is small enough, bitmap otherwise
+    void normalize(Container &container) {
+      if (container.isBitmap() && container.cardinality <= kArrayMax) {
+        std::vector<uint16_t> array;
+        array.reserve(container.cardinality);
+        for (size_t i = 0; i < kWords; ++i) {
+          for (auto word = container.words[i]; word != 0; word &= word - 1) {
+            array.push_back(i * 64 + countTrailingZeros(word));
+          }
+        }
+        container.array = std::move(array);
+        container.words.clear();
+        container.words.shrink_to_fit();
+      } else if (!container.isBitmap() && container.cardinality > kArrayMax) {
+        toBitmap(container);
+      }
+    }
+
+    /**
+     * Combine array containers with same key
+     * @param array_op - std set algorithm on arrays
+     */
+    template <typename ArrayOp>
+    Container combineArrays(const Container &a,
+                            const Container &b,
+                            ArrayOp array_op) {
+      Container result;
+      result.key = a.key;
+      array_op(a.array.begin(),
+               a.array.end(),
+               b.array.begin(),
+               b.array.end(),
+               std::back_inserter(result.array));
+      result.cardinality = result.array.size();
+      normalize(result);
+      return result;
+    }
+
+    /**
+     * Combine bitmap containers with same key
+     * @param word_op - operation on bitmap words
+     */
+    template <typename WordOp>
+    Container combineBitmaps(const Container &a,
+                             const Container &b,
+                             WordOp word_op) {
+      Container result;
+      result.key = a.key;
+      result.words.resize(kWords);
+      for (size_t i = 0; i < kWords; ++i) {
+        result.words[i] = word_op(a.words[i], b.words[i]);
+      }
+      for (auto word : result.words) {
+        result.cardinality += popcount(word);
+      }
+      normalize(result);
+      return result;
+    }
+
+    /**
+     * Filter array container by bitmap container with same key, probing
+     * bitmap word for each value
+     * @param in_bitmap - keep values which are in bitmap or which are not
+     */
+    Container filterArray(const Container &array,
+                          const Container &bitmap,
+                          bool in_bitmap) {
+      Container result;
+      result.key = array.key;
+      for (auto low : array.array) {
+        if (testBit(bitmap.words, low) == in_bitmap) {
+          result.array.push_back(low);
+        }
+      }
+      result.cardinality = result.array.size();
+      return result;
+    }
+
+    /**
+     * Copy bitmap container and set or clear bits of array container with
+     * same key
+     * @param set - set bits or clear them
+     */
+    Container updateBitmap(const Container &bitmap,
+                           const Container &array,
+                           bool set) {
+      Container result{bitmap};
+      for (auto low : array.array) {
+        if (testBit(result.words, low) != set) {
+          result.words[low / 64] ^= uint64_t{1} << (low % 64);
+          set ? ++result.cardinality : --result.cardinality;
+        }
+      }
+      normalize(result);
+      return result;
+    }
+
+    Container unite(const Container &a, const Container &b) {
+      if (!a.isBitmap() && !b.isBitmap()) {
+        return combineArrays(
+            a, b, [](auto... args) { return std::set_union(args...); });
+      }
+      if (a.isBitmap() && b.isBitmap()) {
+        return combineBitmaps(a, b, [](auto x, auto y) { return x | y; });
+      }
+      return a.isBitmap() ? updateBitmap(a, b, true) : updateBitmap(b, a, true);
+    }
+
+    Container intersect(const Container &a, const Container &b) {
+      if (!a.isBitmap() && !b.isBitmap()) {
+        return combineArrays(
+            a, b, [](auto... args) { return std::set_intersection(args...); });
+      }
+      if (a.isBitmap() && b.isBitmap()) {
+        return combineBitmaps(a, b, [](auto x, auto y) { return x & y; });
+      }
+      return a.isBitmap() ? filterArray(b, a, true) : filterArray(a, b, true);
+    }
+
+    Container subtract(const Container &a, const Container &b) {
+      if (!a.isBitmap() && !b.isBitmap()) {
+        return combineArrays(
+            a, b, [](auto... args) { return std::set_difference(args...); });
+      }
+      if (a.isBitmap() && b.isBitmap()) {
+        return combineBitmaps(a, b, [](auto x, auto y) { return x & ~y; });
+      }
+      return a.isBitmap() ? updateBitmap(a, b, false)
+                          : filterArray(a, b, false);
+    }
+
+    /// Append run to sorted runs, merging it with last run if they touch
+    void append(RleBitset::Runs &runs, uint64_t start, uint64_t length) {
+      if (!runs.empty() && runs.back().end() == start) {
+        runs.back().length += length;
+      } else {
+        runs.push_back({start, length});
+      }
+    }
+  }  // namespace
+
+  bool RoaringBitmap::Container::operator==(const Container &other) const {
+    return key == other.key && cardinality == other.cardinality
+           && array == other.array && words == other.words;
+  }
+
+  RoaringBitmap::RoaringBitmap(std::initializer_list<uint64_t> values) {
+    for (auto value : values) {
+      insert(value);
+    }
+  }
+
+  RoaringBitmap RoaringBitmap::fromRleBitset(const RleBitset &set) {
+    RoaringBitmap bitmap;
+    for (const auto &run : set.runs()) {
+      bitmap.appendRange(run.start, run.end());
+    }
+    return bitmap;
+  }
+
+  outcome::result<RoaringBitmap> RoaringBitmap::fromRleBitset(
+      const RleBitset &set, uint64_t max_size) {
+    // runs are checked before conversion, sum of their lengths may overflow
+    uint64_t size{};
+    for (const auto &run : set.runs()) {
+      if (run.length > max_size - size) {
+        return codec::rle::RLEPlusDecodeError::MaxSizeExceed;
+      }
+      size += run.length;
+    }
+    return fromRleBitset(set);
+  }
+
+  RleBitset RoaringBitmap::toRleBitset() const {
+    RleBitset::Runs runs;
+    for (const auto &container : containers_) {
+      auto base = container.key << 16;
+      if (!container.isBitmap()) {
+        for (auto low : container.array) {
+          append(runs, base + low, 1);
+        }
+        continue;
+      }
+      for (size_t i = 0; i < kWords; ++i) {
+        auto word = container.words[i];
+        if (word == kAllOnes) {
+          append(runs, base + i * 64, 64);
+          continue;
+        }
+        while (word != 0) {
+          auto zeros = countTrailingZeros(word);
+          auto ones = countTrailingZeros(~(word >> zeros));
+          append(runs, base + i * 64 + zeros, ones);
+          word = zeros + ones == 64 ? 0 : word & (kAllOnes << (zeros + ones));
+        }
+      }
+    }
+    return RleBitset::fromRuns(std::move(runs));
+  }
+
+  uint64_t RoaringBitmap::size() const {
+    uint64_t size{};
+    for (const auto &container : containers_) {
+      size += container.cardinality;
+    }
+    return size;
+  }
+
+  bool RoaringBitmap::contains(uint64_t value) const {
+    auto key = value >> 16;
+    auto low = static_cast<uint16_t>(value);
+    auto it = std::lower_bound(
+        containers_.begin(),
+        containers_.end(),
+        key,
+        [](auto &container, auto key) { return container.key < key; });
+    if (it == containers_.end() || it->key != key) {
+      return false;
+    }
+    if (it->isBitmap()) {
+      return testBit(it->words, low);
+    }
+    return std::binary_search(it->array.begin(), it->array.end(), low);
+  }
+
+  bool RoaringBitmap::insert(uint64_t value) {
+    auto key = value >> 16;
+    auto low = static_cast<uint16_t>(value);
+    auto it = std::lower_bound(
+        containers_.begin(),
+        containers_.end(),
+        key,
+        [](auto &container, auto key) { return container.key < key; });
+    if (it == containers_.end() || it->key != key) {
+      Container container;
+      container.key = key;
+      it = containers_.insert(it, std::move(container));
+    }
+    if (it->isBitmap()) {
+      auto &word = it->words[low / 64];
+      auto bit = uint64_t{1} << (low % 64);
+      if ((word & bit) != 0) {
+        return false;
+      }
+      word |= bit;
+    } else {
+      auto position = std::lower_bound(it->array.begin(), it->array.end(), low);
+      if (position != it->array.end() && *position == low) {
+        return false;
+      }
+      it->array.insert(position, low);
+    }
+    ++it->cardinality;
+    normalize(*it);
+    return true;
+  }
+
+  bool RoaringBitmap::erase(uint64_t value) {
+    auto key = value >> 16;
+    auto low = static_cast<uint16_t>(value);
+    auto it = std::lower_bound(
+        containers_.begin(),
+        containers_.end(),
+        key,
+        [](auto &container, auto key) { return container.key < key; });
+    if (it == containers_.end() || it->key != key) {
+      return false;
+    }
+    if (it->isBitmap()) {
+      auto &word = it->words[low / 64];
+      auto bit = uint64_t{1} << (low % 64);
+      if ((word & bit) == 0) {
+        return false;
+      }
+      word &= ~bit;
+    } else {
+      auto position = std::lower_bound(it->array.begin(), it->array.end(), low);
+      if (position == it->array.end() || *position != low) {
+        return false;
+      }
+      it->array.erase(position);
+    }
+    if (--it->cardinality == 0) {
+      containers_.erase(it);
+    } else {
+      normalize(*it);
+    }
+    return true;
+  }
+
+  RoaringBitmap RoaringBitmap::operator|(const RoaringBitmap &other) const {
+    RoaringBitmap result;
+    auto a = containers_.begin();
+    auto b = other.containers_.begin();
+    while (a != containers_.end() || b != other.containers_.end()) {
+      if (b == other.containers_.end()
+          || (a != containers_.end() && a->key < b->key)) {
+        result.containers_.push_back(*a++);
+      } else if (a == containers_.end() || b->key < a->key) {
+        result.containers_.push_back(*b++);
+      } else {
+        result.containers_.push_back(unite(*a++, *b++));
+      }
+    }
+    return result;
+  }
+
+  RoaringBitmap RoaringBitmap::operator&(const RoaringBitmap &other) const {
+    RoaringBitmap result;
+    auto a = containers_.begin();
+    auto b = other.containers_.begin();
+    while (a != containers_.end() && b != other.containers_.end()) {
+      if (a->key < b->key) {
+        ++a;
+      } else if (b->key < a->key) {
+        ++b;
+      } else {
+        auto container = intersect(*a++, *b++);
+        if (container.cardinality != 0) {
+          result.containers_.push_back(std::move(container));
+        }
+      }
+    }
+    return result;
+  }
+
+  RoaringBitmap RoaringBitmap::operator-(const RoaringBitmap &other) const {
+    RoaringBitmap result;
+    auto b = other.containers_.begin();
+    for (const auto &a : containers_) {
+      while (b != other.containers_.end() && b->key < a.key) {
+        ++b;
+      }
+      if (b == other.containers_.end() || b->key != a.key) {
+        result.containers_.push_back(a);
+        continue;
+      }
+      auto container = subtract(a, *b);
+      if (container.cardinality != 0) {
+        result.containers_.push_back(std::move(container));
+      }
+    }
+    return result;
+  }
+
+  void RoaringBitmap::appendRange(uint64_t start, uint64_t end) {
+    while (start < end) {
+      auto key = start >> 16;
+      auto low = start % kContainerBits;
+      auto count = std::min(end - start, kContainerBits - low);
+      if (containers_.empty() || containers_.back().key != key) {
+        Container container;
+        container.key = key;
+        containers_.push_back(std::move(container));
+      }
+      auto &container = containers_.back();
+      if (!container.isBitmap() && container.cardinality + count <= kArrayMax) {
+        for (auto value = low; value != low + count; ++value) {
+          container.array.push_back(value);
+        }
+      } else {
+        if (!container.isBitmap()) {
+          toBitmap(container);
+        }
+        for (auto bit = low; bit != low + count;) {
+          auto offset = bit % 64;
+          auto bits = std::min<uint64_t>(64 - offset, low + count - bit);
+          auto mask = bits == 64 ? kAllOnes : ((uint64_t{1} << bits) - 1);
+          container.words[bit / 64] |= mask << offset;
+          bit += bits;
+        }
+      }
+      container.cardinality += count;
+      start += count;
+    }
+  }
+}  // namespace fc::primitives
@@ -0,0 +1,128 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_PRIMITIVES_ROARING_BITMAP_ROARING_BITMAP_HPP
+#define CPP_FILECOIN_CORE_PRIMITIVES_ROARING_BITMAP_ROARING_BITMAP_HPP
+
+#include "primitives/rle_bitset/rle_bitset.hpp"
+
+namespace fc::primitives {
+  /**
+   * Compressed set of integers in roaring bitmap layout. Values are grouped
+   * by high 48 bits into containers of 2^16 values. Container with few
+   * values is sorted array of low 16 bits, dense container is bitmap of 1024
+   * words. Set operations on bitmaps are plain loops over words, which
+   * compiler vectorizes, so dense sets of sectors which are neither
+   * contiguous nor sparse are combined quickly. Contiguous runs take a
+   * bitmap per 2^16 values, so long runs are better kept in RleBitset.
+   */
+  class RoaringBitmap {
+   public:
+    /// Container of values sharing high 48 bits
+    struct Container {
+      /// High 48 bits of values
+      uint64_t key{};
+      /// Count of values
+      uint64_t cardinality{};
+      /// Sorted low 16 bits of values, if cardinality <= kArrayMax
+      std::vector<uint16_t> array;
+      /// Bitmap of low 16 bits of values, if cardinality > kArrayMax
+      std::vector<uint64_t> words;
+
+      bool isBitmap() const {
+        return !words.empty();
+      }
+
+      bool operator==(const Container &other) const;
+    };
+
+    /// Count of bits in container
+    static constexpr uint64_t kContainerBits = 1 << 16;
+    /// Count of words in bitmap container
+    static constexpr size_t kWords = kContainerBits / 64;
+    /// Max cardinality of array container
+    static constexpr uint64_t kArrayMax = 4096;
+    /**
+     * Max count of values decoded from CBOR. Containers take at most about
+     * two bytes per value, so decoded bitmap takes about OBJECT_MAX_SIZE
+     * bytes, while RLE+ input of few bytes may describe 2^64 values.
+     */
+    static constexpr uint64_t kMaxDecodedSize =
+        codec::rle::OBJECT_MAX_SIZE / sizeof(uint16_t);
+
+    RoaringBitmap() = default;
+    RoaringBitmap(std::initializer_list<uint64_t> values);
+
+    /// Convert from runs representation
+    static RoaringBitmap fromRleBitset(const RleBitset &set);
+
+    /**
+     * Convert from runs representation of untrusted size
+     * @param set - runs
+     * @param max_size - max count of values
+     * @return bitmap, or MaxSizeExceed if set has more values than max_size
+     */
+    static outcome::result<RoaringBitmap> fromRleBitset(const RleBitset &set,
+                                                        uint64_t max_size);
+
+    /// Convert to runs representation
+    RleBitset toRleBitset() const;
+
+    const std::vector<Container> &containers() const {
+      return containers_;
+    }
+
+    bool empty() const {
+      return containers_.empty();
+    }
+
+    /// Count of values, O(containers)
+    uint64_t size() const;
+
+    /// Check whether value is in set
+    bool contains(uint64_t value) const;
+
+    /// Add value, returns false if it was in set
+    bool insert(uint64_t value);
+
+    /// Remove value, returns false if it was not in set
+    bool erase(uint64_t value);
+
+    RoaringBitmap operator|(const RoaringBitmap &other) const;
+    RoaringBitmap operator&(const RoaringBitmap &other) const;
+    RoaringBitmap operator-(const RoaringBitmap &other) const;
+
+    bool operator==(const RoaringBitmap &other) const {
+      return containers_ == other.containers_;
+    }
+
+    bool operator!=(const RoaringBitmap &other) const {
+      return !(*this == other);
+    }
+
+   private:
+    /// Add range [start, end) after all values
+    void appendRange(uint64_t start, uint64_t end);
+
+    /// Containers sorted by key
+    std::vector<Container> containers_;
+  };
+
+  CBOR_ENCODE(RoaringBitmap, set) {
+    return s << set.toRleBitset();
+  }
+
+  CBOR_DECODE(RoaringBitmap, set) {
+    RleBitset runs;
+    s >> runs;
+    OUTCOME_EXCEPT(bitmap,
+                   RoaringBitmap::fromRleBitset(
+                       runs, RoaringBitmap::kMaxDecodedSize));
+    set = std::move(bitmap);
+    return s;
+  }
+}  // namespace fc::primitives
+
+#endif  // CPP_FILECOIN_CORE_PRIMITIVES_ROARING_BITMAP_ROARING_BITMAP_HPP
@@ -5,6 +5,9 @@
 
 #include "storage/amt/amt.hpp"
 
+#include <algorithm>
+#include <atomic>
+
 #include "common/which.hpp"
 
 OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::amt, AmtError, e) {
@@ -49,11 +52,23 @@ namespace fc::storage::amt {
     return maskAt(height + 1);
   }
 
+  /// Generate token identifying amt instance, zero is owner of cached nodes
+  uint64_t nextOwner() {
+    static std::atomic<uint64_t> next{1};
+    return next++;
+  }
+
+  void setCid(Node &node, const CID &cid) {
+    node.cid = cid;
+  }
+
   Amt::Amt(std::shared_ptr<ipfs::IpfsDatastore> store)
-      : store_(std::move(store)), root_(Root{}) {}
+      : store_(std::move(store)), root_(Root{}), owner_(nextOwner()) {
+    boost::get<Root>(root_).node.owner = owner_;
+  }
 
   Amt::Amt(std::shared_ptr<ipfs::IpfsDatastore> store, const CID &root)
-      : store_(std::move(store)), root_(root) {}
+      : store_(std::move(store)), root_(root), owner_(nextOwner()) {}
 
   outcome::result<uint64_t> Amt::count() {
     OUTCOME_TRY(loadRoot());
@@ -68,13 +83,17 @@ namespace fc::storage::amt {
     auto &root = boost::get<Root>(root_);
     while (key >= maxAt(root.height)) {
       root.node = {
-          true, Node::Links{{0, std::make_shared<Node>(std::move(root.node))}}};
+          true,
+          Node::Links{{0, std::make_shared<Node>(std::move(root.node))}},
+          boost::none,
+          owner_};
       ++root.height;
     }
     OUTCOME_TRY(add, set(root.node, root.height, key, value));
     if (add) {
       ++root.count;
     }
+    root.cid = boost::none;
     return outcome::success();
   }
 
@@ -88,11 +107,13 @@ namespace fc::storage::amt {
       return AmtError::NOT_FOUND;
     }
     std::reference_wrapper<Node> node = root.node;
+    Node::Ptr holder;
     for (auto height = root.height; height != 0; --height) {
       auto mask = maskAt(height);
-      OUTCOME_TRY(child, loadLink(node, key / mask, false));
+      OUTCOME_TRY(child, loadLink(node, key / mask));
       key %= mask;
       node = *child;
+      holder = std::move(child);
     }
     auto &values = boost::get<Node::Values>(node.get().items);
     auto it = values.find(key);
@@ -113,12 +134,13 @@ namespace fc::storage::amt {
     }
     OUTCOME_TRY(remove(root.node, root.height, key));
     --root.count;
+    root.cid = boost::none;
     while (root.height > 0) {
       auto &links = boost::get<Node::Links>(root.node.items);
-      if (links.size() != 1 && links.find(0) == links.end()) {
+      if (links.size() != 1 || links.find(0) == links.end()) {
         break;
       }
-      OUTCOME_TRY(child, loadLink(root.node, 0, false));
+      OUTCOME_TRY(child, loadMutableLink(root.node, 0, false));
       auto node = std::move(*child);
       root.node = std::move(node);
       --root.height;
@@ -127,19 +149,68 @@ namespace fc::storage::amt {
   }
 
   outcome::result<CID> Amt::flush() {
+    flushed_nodes_ = 0;
     if (which<Root>(root_)) {
       auto &root = boost::get<Root>(root_);
-      OUTCOME_TRY(flush(root.node));
+      if (root.cid) {
+        root_ = *root.cid;
+        return boost::get<CID>(root_);
+      }
+      Writes writes;
+      // subtrees of root links are independent, so they are encoded
+      // concurrently
+      std::vector<Node::Link *> links;
+      if (which<Node::Links>(root.node.items)) {
+        for (auto &pair : boost::get<Node::Links>(root.node.items)) {
+          if (which<Node::Ptr>(pair.second)) {
+            links.push_back(&pair.second);
+          }
+        }
+      }
+      auto encoded = writes.flushConcurrently(
+          executor_, links, [](Node::Link &link, Writes &link_writes) {
+            return flush(link, link_writes);
+          });
+      if (encoded) {
+        encoded = flush(root.node, writes);
+      }
+      if (!encoded) {
+        writes.unflush();
+        return encoded.error();
+      }
+      // links are replaced with CIDs only after all writes succeed
+      OUTCOME_TRY(writes.write([this](const CID &cid, Value bytes) {
+        return store_->set(cid, std::move(bytes));
+      }));
       OUTCOME_TRY(cid, store_->setCbor(root));
+      flushed_nodes_ = writes.size() + 1;
       root_ = cid;
     }
     return boost::get<CID>(root_);
   }
 
+  size_t Amt::flushedNodes() const {
+    return flushed_nodes_;
+  }
+
+  void Amt::setExecutor(common::Executor executor) {
+    executor_ = std::move(executor);
+  }
+
   outcome::result<void> Amt::visit(const Visitor &visitor) {
+    return visit(0, kMaxIndex, visitor);
+  }
+
+  outcome::result<void> Amt::visit(uint64_t from,
+                                   uint64_t to,
+                                   const Visitor &visitor) {
     OUTCOME_TRY(loadRoot());
     auto &root = boost::get<Root>(root_);
-    return visit(root.node, root.height, 0, visitor);
+    to = std::min(to, maxAt(root.height));
+    if (from >= to) {
+      return outcome::success();
+    }
+    return visit(root.node, root.height, 0, from, to, visitor);
   }
 
   outcome::result<bool> Amt::set(Node &node,
@@ -147,13 +218,15 @@ namespace fc::storage::amt {
                                  uint64_t key,
                                  gsl::span<const uint8_t> value) {
     node.has_bits = true;
+    node.cid = boost::none;
     if (height == 0) {
+      // replaces existing value like go-amt-ipld, returns true if key is new
       return boost::get<Node::Values>(node.items)
-          .insert(std::make_pair(key, value))
+          .insert_or_assign(key, Value{value})
           .second;
     }
     auto mask = maskAt(height);
-    OUTCOME_TRY(child, loadLink(node, key / mask, true));
+    OUTCOME_TRY(child, loadMutableLink(node, key / mask, true));
     return set(*child, height - 1, key % mask, value);
   }
 
@@ -163,12 +236,14 @@ namespace fc::storage::amt {
       if (values.erase(key) == 0) {
         return AmtError::NOT_FOUND;
       }
+      node.cid = boost::none;
       return outcome::success();
     }
     auto mask = maskAt(height);
     auto index = key / mask;
-    OUTCOME_TRY(child, loadLink(node, index, false));
+    OUTCOME_TRY(child, loadMutableLink(node, index, false));
     OUTCOME_TRY(remove(*child, height - 1, key % mask));
+    node.cid = boost::none;
     // github.com/filecoin-project/go-amt-ipld/v2 behavior
     auto empty = visit_in_place(
         child->items,
@@ -180,53 +255,104 @@ namespace fc::storage::amt {
     return outcome::success();
   }
 
-  outcome::result<void> Amt::flush(Node &node) {
+  outcome::result<void> Amt::flush(Node &node, Writes &writes) {
     if (which<Node::Links>(node.items)) {
-      auto &links = boost::get<Node::Links>(node.items);
-      for (auto &pair : links) {
-        if (which<Node::Ptr>(pair.second)) {
-          auto &child = *boost::get<Node::Ptr>(pair.second);
-          OUTCOME_TRY(flush(child));
-          OUTCOME_TRY(cid, store_->setCbor(child));
-          pair.second = cid;
-        }
+      for (auto &pair : boost::get<Node::Links>(node.items)) {
+        OUTCOME_TRY(flush(pair.second, writes));
       }
     }
     return outcome::success();
   }
 
+  outcome::result<void> Amt::flush(Node::Link &link, Writes &writes) {
+    if (which<Node::Ptr>(link) && !boost::get<Node::Ptr>(link)->cid) {
+      auto &child = *boost::get<Node::Ptr>(link);
+      OUTCOME_TRY(flush(child, writes));
+      OUTCOME_TRY(bytes, codec::cbor::encode(child));
+      OUTCOME_TRY(cid, common::getCidOf(bytes));
+      child.cid = cid;
+      writes.add(std::move(cid), Value{bytes}, child);
+    }
+    return outcome::success();
+  }
+
   outcome::result<void> Amt::visit(Node &node,
                                    uint64_t height,
                                    uint64_t offset,
+                                   uint64_t from,
+                                   uint64_t to,
                                    const Visitor &visitor) {
+    // node covers keys from offset and intersects range
+    auto first = from > offset ? from - offset : 0;
+    auto last = to - offset;
     if (height == 0) {
-      for (auto &it : boost::get<Node::Values>(node.items)) {
-        OUTCOME_TRY(visitor(offset + it.first, it.second));
+      auto &values = boost::get<Node::Values>(node.items);
+      for (auto it = values.lower_bound(first);
+           it != values.end() && it->first < last;
+           ++it) {
+        OUTCOME_TRY(visitor(offset + it->first, it->second));
       }
       return outcome::success();
     }
     auto mask = maskAt(height);
-    for (auto &it : boost::get<Node::Links>(node.items)) {
-      OUTCOME_TRY(loadLink(node, it.first, false));
-      OUTCOME_TRY(visit(*boost::get<Node::Ptr>(it.second),
+    auto &links = boost::get<Node::Links>(node.items);
+    auto begin = links.lower_bound(first / mask);
+    auto end = links.lower_bound((last + mask - 1) / mask);
+    OUTCOME_TRY(children, loadLinks(begin, end, node.owner == owner_));
+    auto it = begin;
+    for (auto &child : children) {
+      OUTCOME_TRY(visit(*child,
                         height - 1,
-                        offset + it.first * mask,
+                        offset + it->first * mask,
+                        from,
+                        to,
                         visitor));
+      ++it;
     }
     return outcome::success();
   }
 
   outcome::result<void> Amt::loadRoot() {
     if (which<CID>(root_)) {
-      OUTCOME_TRY(root, store_->getCbor<Root>(boost::get<CID>(root_)));
-      root_ = root;
+      auto &cid = boost::get<CID>(root_);
+      OUTCOME_TRY(root, store_->getCborCached<Root>(cid));
+      // copy is shallow, children are loaded and shared separately
+      auto copy = *root.value;
+      copy.cid = cid;
+      copy.node.owner = owner_;
+      root_ = std::move(copy);
     }
     return outcome::success();
   }
 
-  outcome::result<Node::Ptr> Amt::loadLink(Node &parent,
-                                           uint64_t index,
-                                           bool create) {
+  outcome::result<Node::Ptr> Amt::loadLink(Node &parent, uint64_t index) {
+    if (!which<Node::Links>(parent.items)) {
+      return AmtError::NOT_FOUND;
+    }
+    auto &links = boost::get<Node::Links>(parent.items);
+    auto it = links.find(index);
+    if (it == links.end()) {
+      return AmtError::NOT_FOUND;
+    }
+    auto &link = it->second;
+    if (which<Node::Ptr>(link)) {
+      return boost::get<Node::Ptr>(link);
+    }
+    OUTCOME_TRY(loaded,
+                store_->getCborCached<Node>(boost::get<CID>(link), setCid));
+    auto node = std::const_pointer_cast<Node>(loaded.value);
+    if (!loaded.cached) {
+      node->owner = owner_;
+    }
+    if (parent.owner == owner_) {
+      link = node;
+    }
+    return node;
+  }
+
+  outcome::result<Node::Ptr> Amt::loadMutableLink(Node &parent,
+                                                  uint64_t index,
+                                                  bool create) {
     if (which<Node::Values>(parent.items)
         && boost::get<Node::Values>(parent.items).empty()) {
       parent.items = Node::Links{};
@@ -236,6 +362,7 @@ namespace fc::storage::amt {
     if (it == links.end()) {
       if (create) {
         auto node = std::make_shared<Node>();
+        node->owner = owner_;
         links[index] = node;
         return node;
       }
@@ -243,9 +370,52 @@ namespace fc::storage::amt {
     }
     auto &link = it->second;
     if (which<CID>(link)) {
-      OUTCOME_TRY(node, store_->getCbor<Node>(boost::get<CID>(link)));
-      link = std::make_shared<Node>(std::move(node));
+      OUTCOME_TRY(loaded,
+                  store_->getCborCached<Node>(boost::get<CID>(link), setCid));
+      // copy value shared with decoded cache
+      auto node = loaded.cached ? std::make_shared<Node>(*loaded.value)
+                                : std::const_pointer_cast<Node>(loaded.value);
+      node->owner = owner_;
+      link = node;
+      return node;
+    }
+    auto &node = boost::get<Node::Ptr>(link);
+    if (node->owner != owner_) {
+      // shared with decoded cache
+      node = std::make_shared<Node>(*node);
+      node->owner = owner_;
+    }
+    return node;
+  }
+
+  outcome::result<std::vector<Node::Ptr>> Amt::loadLinks(
+      Node::Links::iterator begin, Node::Links::iterator end, bool owned) {
+    std::vector<Node::Ptr> nodes;
+    std::vector<size_t> positions;
+    std::vector<CID> cids;
+    for (auto it = begin; it != end; ++it) {
+      if (which<CID>(it->second)) {
+        positions.push_back(nodes.size());
+        cids.push_back(boost::get<CID>(it->second));
+        nodes.emplace_back();
+      } else {
+        nodes.push_back(boost::get<Node::Ptr>(it->second));
+      }
+    }
+    OUTCOME_TRY(loaded, store_->getCborMany<Node>(cids, executor_, setCid));
+    for (size_t i = 0; i < loaded.size(); ++i) {
+      auto node = std::const_pointer_cast<Node>(loaded[i].value);
+      if (!loaded[i].cached) {
+        node->owner = owner_;
+      }
+      nodes[positions[i]] = std::move(node);
+    }
+    if (owned) {
+      auto node = nodes.begin();
+      for (auto it = begin; it != end; ++it, ++node) {
+        it->second = *node;
+      }
     }
-    return boost::get<Node::Ptr>(link);
+    return nodes;
   }
 }  // namespace fc::storage::amt
@@ -9,6 +9,8 @@
 #include <boost/variant.hpp>
 
 #include "codec/cbor/cbor.hpp"
+#include "common/executor.hpp"
+#include "common/flush_writes.hpp"
 #include "common/outcome_throw.hpp"
 #include "common/visitor.hpp"
 #include "common/which.hpp"
@@ -43,6 +45,14 @@ namespace fc::storage::amt {
     /// github.com/filecoin-project/go-amt-ipld does not truncate zero bits
     bool has_bits{};
     Items items;
+    /// CID node was loaded from or flushed to, reset on modification, not
+    /// encoded
+    boost::optional<CID> cid;
+    /**
+     * Token of amt allowed to modify node in place, zero if node may be
+     * shared with decoded cache, not encoded
+     */
+    uint64_t owner{};
   };
 
   CBOR_ENCODE(Node, node) {
@@ -56,10 +66,16 @@ namespace fc::storage::amt {
           [&bits, &l_links](const Node::Links &links) {
             for (auto &item : links) {
               bits[0] |= 1 << item.first;
-              if (which<Node::Ptr>(item.second)) {
+              if (which<CID>(item.second)) {
+                l_links << boost::get<CID>(item.second);
+                continue;
+              }
+              // unmodified node is encoded as link to it
+              auto &ptr = boost::get<Node::Ptr>(item.second);
+              if (!ptr || !ptr->cid) {
                 outcome::raise(AmtError::EXPECTED_CID);
               }
-              l_links << boost::get<CID>(item.second);
+              l_links << *ptr->cid;
             }
           },
           [&bits, &l_values](const Node::Values &values) {
@@ -121,6 +137,8 @@ namespace fc::storage::amt {
     uint64_t height{};
     uint64_t count{};
     Node node;
+    /// CID root was loaded from, reset on modification, not encoded
+    boost::optional<CID> cid;
   };
 
   CBOR_TUPLE(Root, height, count, node)
@@ -132,18 +150,46 @@ namespace fc::storage::amt {
 
     explicit Amt(std::shared_ptr<ipfs::IpfsDatastore> store);
     Amt(std::shared_ptr<ipfs::IpfsDatastore> store, const CID &root);
+    /// Not copyable, because nodes owned by amt are modified in place
+    Amt(const Amt &other) = delete;
+    Amt(Amt &&other) = default;
+    Amt &operator=(const Amt &other) = delete;
+    Amt &operator=(Amt &&other) = default;
     /// Get values quantity
     outcome::result<uint64_t> count();
-    /// Set value by key, does not write to storage
+    /// Set value by key, replacing existing one, does not write to storage
     outcome::result<void> set(uint64_t key, gsl::span<const uint8_t> value);
     /// Get value by key
     outcome::result<Value> get(uint64_t key);
     /// Remove value by key, does not write to storage
     outcome::result<void> remove(uint64_t key);
-    /// Write changes made by set and remove to storage
+    /**
+     * Write changes made by set and remove to storage. Only nodes modified
+     * since load are encoded and written, unmodified nodes keep their CID.
+     */
     outcome::result<CID> flush();
+    /// Count of nodes written by last flush, including root
+    size_t flushedNodes() const;
+    /**
+     * Set executor for flush and visit. Flush encodes modified links of root
+     * node concurrently, visit decodes linked children of node covering range
+     * in one batch.
+     * @param executor - executor, empty to flush and load serially
+     */
+    void setExecutor(common::Executor executor);
     /// Apply visitor for key value pairs
     outcome::result<void> visit(const Visitor &visitor);
+    /**
+     * Apply visitor for key value pairs with keys in range, descending only
+     * into nodes covering range. Children of each node in range are loaded
+     * before descending into first of them.
+     * @param from - first key of range
+     * @param to - key after last key of range
+     * @param visitor - visitor
+     */
+    outcome::result<void> visit(uint64_t from,
+                                uint64_t to,
+                                const Visitor &visitor);
 
     /// Store CBOR encoded value by key
     template <typename T>
@@ -165,18 +211,45 @@ namespace fc::storage::amt {
                               uint64_t key,
                               gsl::span<const uint8_t> value);
     outcome::result<bool> remove(Node &node, uint64_t height, uint64_t key);
-    outcome::result<void> flush(Node &node);
+    using Writes = common::FlushWrites<CID, Node>;
+
+    static outcome::result<void> flush(Node &node, Writes &writes);
+    static outcome::result<void> flush(Node::Link &link, Writes &writes);
     outcome::result<void> visit(Node &node,
                                 uint64_t height,
                                 uint64_t offset,
+                                uint64_t from,
+                                uint64_t to,
                                 const Visitor &visitor);
     outcome::result<void> loadRoot();
-    outcome::result<Node::Ptr> loadLink(Node &node,
-                                        uint64_t index,
-                                        bool create);
+    /**
+     * Load child node by link index. Loaded node may be shared with decoded
+     * cache, so it is modified only through loadMutableLink. Loaded node is
+     * stored in parent if parent is owned by this amt.
+     */
+    outcome::result<Node::Ptr> loadLink(Node &node, uint64_t index);
+    /**
+     * Load child node for modification, copying it if it is not owned by this
+     * amt. Parent must be owned by this amt.
+     * @param create - create empty child if link is missing
+     */
+    outcome::result<Node::Ptr> loadMutableLink(Node &node,
+                                               uint64_t index,
+                                               bool create);
+    /**
+     * Load children of node in range of link indices in one batch
+     * @param owned - parent is owned by this amt, so nodes are stored in it
+     * @return nodes in order of links
+     */
+    outcome::result<std::vector<Node::Ptr>> loadLinks(
+        Node::Links::iterator begin, Node::Links::iterator end, bool owned);
 
     std::shared_ptr<ipfs::IpfsDatastore> store_;
     boost::variant<CID, Root> root_;
+    common::Executor executor_;
+    size_t flushed_nodes_{};
+    /// Token of nodes modified in place by this amt
+    uint64_t owner_;
   };
 }  // namespace fc::storage::amt
 
@@ -0,0 +1,117 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/amt/amt_builder.hpp"
+
+namespace fc::storage::amt {
+  namespace {
+    /// Full prefix of values or links, encoded same as Node
+    struct NodeView {
+      gsl::span<const Value> values;
+      gsl::span<const CID> links;
+    };
+
+    CBOR_ENCODE(NodeView, node) {
+      auto size = node.values.size() + node.links.size();
+      std::vector<uint8_t> bits{static_cast<uint8_t>((1u << size) - 1)};
+      auto l_links = s.list();
+      for (auto &cid : node.links) {
+        l_links << cid;
+      }
+      auto l_values = s.list();
+      for (auto &value : node.values) {
+        l_values << l_values.wrap(value, 1);
+      }
+      return s << (s.list() << bits << l_links << l_values);
+    }
+  }  // namespace
+
+  AmtBuilder::AmtBuilder(std::shared_ptr<ipfs::IpfsDatastore> store)
+      : store_{std::move(store)} {}
+
+  outcome::result<void> AmtBuilder::append(gsl::span<const uint8_t> value) {
+    if (count_ >= kMaxIndex) {
+      return AmtError::INDEX_TOO_BIG;
+    }
+    if (values_.size() == kWidth) {
+      OUTCOME_TRY(seal(0));
+    }
+    values_.emplace_back(value);
+    ++count_;
+    return outcome::success();
+  }
+
+  uint64_t AmtBuilder::count() const {
+    return count_;
+  }
+
+  outcome::result<CID> AmtBuilder::build() {
+    // height of root is count of levels with links, it may grow while
+    // partial nodes below are sealed
+    for (size_t height = 0; height < links_.size(); ++height) {
+      auto partial =
+          height == 0 ? !values_.empty() : !links_[height - 1].empty();
+      if (partial) {
+        OUTCOME_TRY(seal(height));
+      }
+    }
+    Root root;
+    root.height = links_.size();
+    root.count = count_;
+    if (links_.empty()) {
+      root.node.has_bits = !values_.empty();
+      Node::Values values;
+      for (size_t i = 0; i < values_.size(); ++i) {
+        values.emplace(i, std::move(values_[i]));
+      }
+      root.node.items = std::move(values);
+    } else {
+      root.node.has_bits = true;
+      Node::Links links;
+      auto &cids = links_.back();
+      for (size_t i = 0; i < cids.size(); ++i) {
+        links.emplace(i, std::move(cids[i]));
+      }
+      root.node.items = std::move(links);
+    }
+    values_.clear();
+    links_.clear();
+    count_ = 0;
+    OUTCOME_TRY(cid, store_->setCbor(root));
+    written_nodes_ = sealed_nodes_ + 1;
+    sealed_nodes_ = 0;
+    return std::move(cid);
+  }
+
+  size_t AmtBuilder::writtenNodes() const {
+    return written_nodes_;
+  }
+
+  outcome::result<void> AmtBuilder::seal(size_t height) {
+    if (links_.size() <= height) {
+      links_.resize(height + 1);
+    }
+    if (links_[height].size() == kWidth) {
+      OUTCOME_TRY(seal(height + 1));
+    }
+    NodeView node;
+    if (height == 0) {
+      node.values = values_;
+    } else {
+      node.links = links_[height - 1];
+    }
+    OUTCOME_TRY(bytes, codec::cbor::encode(node));
+    OUTCOME_TRY(cid, common::getCidOf(bytes));
+    OUTCOME_TRY(store_->set(cid, Value{bytes}));
+    ++sealed_nodes_;
+    if (height == 0) {
+      values_.clear();
+    } else {
+      links_[height - 1].clear();
+    }
+    links_[height].push_back(std::move(cid));
+    return outcome::success();
+  }
+}  // namespace fc::storage::amt
@@ -0,0 +1,66 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_STORAGE_AMT_AMT_BUILDER_HPP
+#define CPP_FILECOIN_STORAGE_AMT_AMT_BUILDER_HPP
+
+#include "storage/amt/amt.hpp"
+
+namespace fc::storage::amt {
+
+  /**
+   * Builds amt from values appended at sequential indices starting from 0.
+   * Leaves are filled left to right and each full node is encoded and written
+   * as soon as next value needs its slot, so only one partial node per level
+   * is kept in memory. Resulting root is same as after setting all values to
+   * empty amt and flushing it.
+   */
+  class AmtBuilder {
+   public:
+    explicit AmtBuilder(std::shared_ptr<ipfs::IpfsDatastore> store);
+
+    /** Append value at next index, may write full nodes to storage */
+    outcome::result<void> append(gsl::span<const uint8_t> value);
+
+    /// Append CBOR encoded value at next index
+    template <typename T>
+    outcome::result<void> appendCbor(const T &value) {
+      OUTCOME_TRY(bytes, codec::cbor::encode(value));
+      return append(bytes);
+    }
+
+    /// Count of values appended since last build
+    uint64_t count() const;
+
+    /**
+     * Write remaining nodes and root to storage and clear appended values
+     * @return root of amt
+     */
+    outcome::result<CID> build();
+
+    /**
+     * Returns count of nodes written to storage by appends and last build
+     * since previous build, including root
+     */
+    size_t writtenNodes() const;
+
+   private:
+    /// Write partial node at height and link it from node above
+    outcome::result<void> seal(size_t height);
+
+    std::shared_ptr<ipfs::IpfsDatastore> store_;
+    /// Values of partial leaf
+    std::vector<Value> values_;
+    /// Links of partial node at height i + 1
+    std::vector<std::vector<CID>> links_;
+    uint64_t count_{};
+    /// Count of nodes written by appends and build in progress
+    size_t sealed_nodes_{};
+    size_t written_nodes_{};
+  };
+
+}  // namespace fc::storage::amt
+
+#endif  // CPP_FILECOIN_STORAGE_AMT_AMT_BUILDER_HPP
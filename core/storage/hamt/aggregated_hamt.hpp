@@ -0,0 +1,230 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_STORAGE_HAMT_AGGREGATED_HAMT_HPP
+#define CPP_FILECOIN_STORAGE_HAMT_AGGREGATED_HAMT_HPP
+
+#include <set>
+
+#include "storage/hamt/hamt.hpp"
+
+namespace fc::storage::hamt {
+
+  /**
+   * Aggregate over decoded hamt values, maintained by AggregatedHamt
+   * @tparam T - decoded value type
+   */
+  template <typename T>
+  class Aggregate {
+   public:
+    virtual ~Aggregate() = default;
+
+    /** Account value added to hamt */
+    virtual void add(const T &value) = 0;
+
+    /** Account value removed from hamt */
+    virtual void remove(const T &value) = 0;
+
+    /** Forget all values */
+    virtual void clear() = 0;
+  };
+
+  /// Sum of values, T must support + and -
+  template <typename T>
+  class SumAggregate : public Aggregate<T> {
+   public:
+    void add(const T &value) override {
+      sum_ = sum_ + value;
+    }
+
+    void remove(const T &value) override {
+      sum_ = sum_ - value;
+    }
+
+    void clear() override {
+      sum_ = T{};
+    }
+
+    const T &value() const {
+      return sum_;
+    }
+
+   private:
+    T sum_{};
+  };
+
+  /**
+   * Max of values, T must be ordered. Keeps all values in multiset to find
+   * next max after removal, so memory is O(n) in count of hamt values.
+   */
+  template <typename T>
+  class MaxAggregate : public Aggregate<T> {
+   public:
+    void add(const T &value) override {
+      values_.insert(value);
+    }
+
+    void remove(const T &value) override {
+      auto it = values_.find(value);
+      if (it != values_.end()) {
+        values_.erase(it);
+      }
+    }
+
+    void clear() override {
+      values_.clear();
+    }
+
+    /** Returns max value or none if there are no values */
+    boost::optional<T> value() const {
+      if (values_.empty()) {
+        return boost::none;
+      }
+      return *values_.rbegin();
+    }
+
+   private:
+    std::multiset<T> values_;
+  };
+
+  /**
+   * Hamt of CBOR encoded values with entry count and aggregates maintained in
+   * memory. Aggregates are computed by single visit of hamt on first query
+   * and then updated on set and remove, so queries are O(1).
+   * Not copyable, because aggregates are shared with their owner, so copy
+   * would update them too.
+   * @tparam T - value type
+   */
+  template <typename T>
+  class AggregatedHamt {
+   public:
+    using Aggregates = std::vector<std::shared_ptr<Aggregate<T>>>;
+
+    /**
+     * @param hamt - hamt of CBOR encoded values
+     * @param aggregates - aggregates to maintain
+     */
+    explicit AggregatedHamt(Hamt hamt, Aggregates aggregates = {})
+        : hamt_{std::move(hamt)}, aggregates_{std::move(aggregates)} {}
+    AggregatedHamt(const AggregatedHamt &) = delete;
+    AggregatedHamt(AggregatedHamt &&) = default;
+    AggregatedHamt &operator=(const AggregatedHamt &) = delete;
+    AggregatedHamt &operator=(AggregatedHamt &&) = default;
+
+    /** Get value by key */
+    outcome::result<T> get(std::string_view key) {
+      return hamt_.getCbor<T>(key);
+    }
+
+    /** Set value by key, does not write to storage */
+    outcome::result<void> set(std::string_view key, const T &value) {
+      OUTCOME_TRY(bytes, codec::cbor::encode(value));
+      OUTCOME_TRY(old_bytes, hamt_.exchange(key, bytes));
+      if (loaded_) {
+        boost::optional<T> old;
+        if (old_bytes) {
+          auto old2 = codec::cbor::decode<T>(*old_bytes);
+          if (!old2) {
+            // hamt is already changed, recompute aggregates on next query
+            loaded_ = false;
+            return old2.error();
+          }
+          old = std::move(old2.value());
+        }
+        for (auto &aggregate : aggregates_) {
+          if (old) {
+            aggregate->remove(*old);
+          }
+          aggregate->add(value);
+        }
+        if (!old) {
+          ++size_;
+        }
+      }
+      return outcome::success();
+    }
+
+    /**
+     * Remove value by key, does not write to storage.
+     * Returns NOT_FOUND if element doesn't exist.
+     */
+    outcome::result<void> remove(std::string_view key) {
+      boost::optional<T> old;
+      if (loaded_) {
+        OUTCOME_TRY(old2, find(key));
+        old = std::move(old2);
+      }
+      OUTCOME_TRY(hamt_.remove(key));
+      if (old) {
+        for (auto &aggregate : aggregates_) {
+          aggregate->remove(*old);
+        }
+        --size_;
+      }
+      return outcome::success();
+    }
+
+    /** Returns count of entries */
+    outcome::result<size_t> size() {
+      OUTCOME_TRY(load());
+      return size_;
+    }
+
+    /** Computes count and aggregates if not computed yet */
+    outcome::result<void> load() {
+      if (!loaded_) {
+        for (auto &aggregate : aggregates_) {
+          aggregate->clear();
+        }
+        size_ = 0;
+        OUTCOME_TRY(hamt_.visit(
+            [this](auto &, auto &bytes) -> outcome::result<void> {
+              OUTCOME_TRY(value, codec::cbor::decode<T>(bytes));
+              for (auto &aggregate : aggregates_) {
+                aggregate->add(value);
+              }
+              ++size_;
+              return outcome::success();
+            }));
+        loaded_ = true;
+      }
+      return outcome::success();
+    }
+
+    /**
+     * Replace hamt, e.g. after loading other root. Count and aggregates are
+     * recomputed on next query.
+     */
+    void reset(Hamt hamt) {
+      hamt_ = std::move(hamt);
+      loaded_ = false;
+    }
+
+    /** Underlying hamt, must not be modified directly */
+    Hamt &hamt() {
+      return hamt_;
+    }
+
+   private:
+    outcome::result<boost::optional<T>> find(std::string_view key) {
+      auto value = hamt_.getCbor<T>(key);
+      if (!value) {
+        if (value.error() == HamtError::NOT_FOUND) {
+          return boost::none;
+        }
+        return value.error();
+      }
+      return std::move(value.value());
+    }
+
+    Hamt hamt_;
+    Aggregates aggregates_;
+    bool loaded_{};
+    size_t size_{};
+  };
+
+}  // namespace fc::storage::hamt
+
+#endif  // CPP_FILECOIN_STORAGE_HAMT_AGGREGATED_HAMT_HPP
@@ -5,8 +5,9 @@
 
 #include "storage/hamt/hamt.hpp"
 
+#include <atomic>
+
 #include "common/which.hpp"
-#include "crypto/murmur/murmur.hpp"
 
 OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::hamt, HamtError, e) {
   using fc::storage::hamt::HamtError;
@@ -17,6 +18,8 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::hamt, HamtError, e) {
       return "Not found";
     case HamtError::MAX_DEPTH:
       return "Max depth exceeded";
+    case HamtError::INVALID_BIT_WIDTH:
+      return "Invalid bit width";
   }
   return "Unknown error";
 }
@@ -24,60 +27,250 @@ OUTCOME_CPP_DEFINE_CATEGORY(fc::storage::hamt, HamtError, e) {
 namespace fc::storage::hamt {
   using fc::common::which;
 
-  auto consumeIndex(gsl::span<const size_t> indices) {
-    return indices.subspan(1);
+  /// CID of item if it is known without encoding
+  boost::optional<CID> cidOf(const Node::Item &item) {
+    if (which<CID>(item)) {
+      return boost::get<CID>(item);
+    }
+    if (which<Node::Ptr>(item)) {
+      return boost::get<Node::Ptr>(item)->cid;
+    }
+    return boost::none;
+  }
+
+  size_t checkBitWidth(size_t bit_width) {
+    if (bit_width == 0 || bit_width > kMaxBitWidth) {
+      outcome::raise(HamtError::INVALID_BIT_WIDTH);
+    }
+    return bit_width;
+  }
+
+  std::string_view keyView(gsl::span<const uint8_t> key) {
+    return {reinterpret_cast<const char *>(key.data()),
+            static_cast<size_t>(key.size())};
+  }
+
+  /// Owner of nodes which may be shared with decoded cache
+  constexpr uint64_t kCacheOwner = 0;
+  /// Owner of nodes loaded into nodes shared between snapshots
+  constexpr uint64_t kSharedOwner = 1;
+
+  /// Generate token identifying hamt version
+  uint64_t nextOwner() {
+    static std::atomic<uint64_t> next{kSharedOwner + 1};
+    return next++;
+  }
+
+  HashPath::HashPath(std::string_view key, size_t bit_width)
+      : hash_{}, bit_width_{bit_width} {
+    auto digest = crypto::murmur::hash(gsl::make_span(
+        reinterpret_cast<const uint8_t *>(key.data()), key.size()));
+    for (auto byte : digest) {
+      hash_ = (hash_ << 8) | byte;
+    }
+  }
+
+  HashPath::HashPath(gsl::span<const uint8_t> key, size_t bit_width)
+      : HashPath{keyView(key), bit_width} {}
+
+  size_t HashPath::index() const {
+    return (hash_ << offset_) >> (64 - bit_width_);
+  }
+
+  size_t HashPath::size() const {
+    return (64 - offset_) / bit_width_;
+  }
+
+  bool HashPath::empty() const {
+    return size() == 0;
+  }
+
+  HashPath HashPath::next() const {
+    auto path = *this;
+    path.offset_ += bit_width_;
+    return path;
+  }
+
+  HashPath HashPath::forKey(std::string_view key) const {
+    HashPath path{key, bit_width_};
+    path.offset_ = offset_;
+    return path;
+  }
+
+  HashPath HashPath::forKey(gsl::span<const uint8_t> key) const {
+    return forKey(keyView(key));
+  }
+
+  uint64_t HashPath::hash() const {
+    return hash_;
+  }
+
+  Node::Leaf::Leaf(std::initializer_list<value_type> pairs) {
+    for (auto &pair : pairs) {
+      emplace(pair.first, pair.second);
+    }
+  }
+
+  template <typename It>
+  It lowerBound(It begin, It end, std::string_view key) {
+    return std::lower_bound(begin, end, key, [](auto &pair, auto &key) {
+      return pair.first < key;
+    });
+  }
+
+  Node::Leaf::iterator Node::Leaf::find(std::string_view key) {
+    auto it = lowerBound(begin(), end(), key);
+    return it != end() && it->first == key ? it : end();
+  }
+
+  Node::Leaf::const_iterator Node::Leaf::find(std::string_view key) const {
+    auto it = lowerBound(begin(), end(), key);
+    return it != end() && it->first == key ? it : end();
+  }
+
+  Node::Leaf::iterator Node::Leaf::find(gsl::span<const uint8_t> key) {
+    return find(keyView(key));
+  }
+
+  Node::Leaf::const_iterator Node::Leaf::find(
+      gsl::span<const uint8_t> key) const {
+    return find(keyView(key));
+  }
+
+  Value &Node::Leaf::operator[](std::string_view key) {
+    return emplace(key, {}).first->second;
+  }
+
+  std::pair<Node::Leaf::iterator, bool> Node::Leaf::emplace(
+      std::string_view key, Value value) {
+    auto it = lowerBound(begin(), end(), key);
+    if (it != end() && it->first == key) {
+      return {it, false};
+    }
+    return {pairs_.emplace(it, key, std::move(value)), true};
+  }
+
+  size_t Node::Leaf::erase(std::string_view key) {
+    auto it = find(key);
+    if (it == end()) {
+      return 0;
+    }
+    pairs_.erase(it);
+    return 1;
+  }
+
+  size_t Node::Leaf::size() const {
+    return pairs_.size();
+  }
+
+  bool Node::Leaf::empty() const {
+    return pairs_.empty();
+  }
+
+  Node::Leaf::iterator Node::Leaf::begin() {
+    return pairs_.begin();
+  }
+
+  Node::Leaf::iterator Node::Leaf::end() {
+    return pairs_.end();
+  }
+
+  Node::Leaf::const_iterator Node::Leaf::begin() const {
+    return pairs_.begin();
+  }
+
+  Node::Leaf::const_iterator Node::Leaf::end() const {
+    return pairs_.end();
   }
 
   Hamt::Hamt(std::shared_ptr<ipfs::IpfsDatastore> store, size_t bit_width)
       : store_{std::move(store)},
         root_{std::make_shared<Node>()},
-        bit_width_{bit_width} {}
+        bit_width_{checkBitWidth(bit_width)},
+        owner_{nextOwner()} {
+    boost::get<Node::Ptr>(root_)->owner = owner_;
+  }
 
   Hamt::Hamt(std::shared_ptr<ipfs::IpfsDatastore> store, Node::Ptr root)
       : store_{std::move(store)},
-        root_{std::move(root)},
-        bit_width_{kDefaultBitWidth} {}
+        bit_width_{kDefaultBitWidth},
+        owner_{nextOwner()} {
+    root->owner = owner_;
+    root_ = std::move(root);
+  }
 
   Hamt::Hamt(std::shared_ptr<ipfs::IpfsDatastore> store,
              const CID &root,
              size_t bit_width)
-      : store_{std::move(store)}, root_{root}, bit_width_{bit_width} {}
+      : store_{std::move(store)},
+        root_{root},
+        bit_width_{checkBitWidth(bit_width)},
+        owner_{nextOwner()} {}
+
+  Hamt Hamt::snapshot() {
+    Hamt snapshot{*this};
+    snapshot.owner_ = nextOwner();
+    owner_ = nextOwner();
+    return snapshot;
+  }
+
+  outcome::result<void> Hamt::set(std::string_view key,
+                                  gsl::span<const uint8_t> value) {
+    OUTCOME_TRY(exchange(key, value));
+    return outcome::success();
+  }
 
-  outcome::result<void> Hamt::set(const std::string &key,
+  outcome::result<void> Hamt::set(gsl::span<const uint8_t> key,
                                   gsl::span<const uint8_t> value) {
+    return set(keyView(key), value);
+  }
+
+  outcome::result<boost::optional<Value>> Hamt::exchange(
+      std::string_view key, gsl::span<const uint8_t> value) {
     OUTCOME_TRY(loadItem(root_));
-    return set(*boost::get<Node::Ptr>(root_), keyToIndices(key), key, value);
+    boost::optional<Value> old;
+    OUTCOME_TRY(
+        set(mutableNode(root_), HashPath{key, bit_width_}, key, value, old));
+    return old;
   }
 
-  outcome::result<Value> Hamt::get(const std::string &key) {
+  outcome::result<Value> Hamt::get(std::string_view key) {
     OUTCOME_TRY(loadItem(root_));
     auto node = boost::get<Node::Ptr>(root_);
-    for (auto index : keyToIndices(key)) {
-      auto it = node->items.find(index);
+    for (HashPath path{key, bit_width_}; !path.empty(); path = path.next()) {
+      auto it = node->items.find(path.index());
       if (it == node->items.end()) {
         return HamtError::NOT_FOUND;
       }
       auto &item = it->second;
-      OUTCOME_TRY(loadItem(item));
-      if (which<Node::Ptr>(item)) {
-        node = boost::get<Node::Ptr>(item);
-      } else {
+      if (which<Node::Leaf>(item)) {
         auto &leaf = boost::get<Node::Leaf>(item);
-        if (leaf.find(key) == leaf.end()) {
+        auto it = leaf.find(key);
+        if (it == leaf.end()) {
           return HamtError::NOT_FOUND;
         }
-        return leaf[key];
+        return it->second;
       }
+      OUTCOME_TRY(child, loadChild(*node, item));
+      node = std::move(child);
     }
     return HamtError::MAX_DEPTH;
   }
 
-  outcome::result<void> Hamt::remove(const std::string &key) {
+  outcome::result<Value> Hamt::get(gsl::span<const uint8_t> key) {
+    return get(keyView(key));
+  }
+
+  outcome::result<void> Hamt::remove(std::string_view key) {
     OUTCOME_TRY(loadItem(root_));
-    return remove(*boost::get<Node::Ptr>(root_), keyToIndices(key), key);
+    return remove(mutableNode(root_), HashPath{key, bit_width_}, key);
   }
 
-  outcome::result<bool> Hamt::contains(const std::string &key) {
+  outcome::result<void> Hamt::remove(gsl::span<const uint8_t> key) {
+    return remove(keyView(key));
+  }
+
+  outcome::result<bool> Hamt::contains(std::string_view key) {
     auto res = get(key);
     if (!res) {
       if (res.error() == HamtError::NOT_FOUND) return false;
@@ -86,78 +279,110 @@ namespace fc::storage::hamt {
     return true;
   }
 
-  outcome::result<CID> Hamt::flush() {
-    OUTCOME_TRY(flush(root_));
-    return boost::get<CID>(root_);
+  outcome::result<bool> Hamt::contains(gsl::span<const uint8_t> key) {
+    return contains(keyView(key));
   }
 
-  std::vector<size_t> Hamt::keyToIndices(const std::string &key, int n) const {
-    std::vector<uint8_t> key_bytes(key.begin(), key.end());
-    auto hash = crypto::murmur::hash(key_bytes);
-    std::vector<size_t> indices;
-    constexpr auto byte_bits = 8;
-    auto max_bits = byte_bits * hash.size();
-    max_bits -= max_bits % bit_width_;
-    auto offset = 0;
-    if (n != -1) {
-      offset = max_bits - (n - 1) * bit_width_;
-    }
-    while (offset + bit_width_ <= max_bits) {
-      size_t index = 0;
-      for (auto i = 0u; i < bit_width_; ++i, ++offset) {
-        index <<= 1;
-        index |= 1
-                 & (hash[offset / byte_bits]
-                    >> (byte_bits - 1 - offset % byte_bits));
+  outcome::result<CID> Hamt::flush() {
+    flushed_nodes_ = 0;
+    Writes writes;
+    outcome::result<void> encoded = outcome::success();
+    if (which<Node::Ptr>(root_) && !boost::get<Node::Ptr>(root_)->cid) {
+      // shards of root are independent, so they are encoded concurrently
+      std::vector<Node::Item *> shards;
+      for (auto &item : mutableNode(root_).items) {
+        if (which<Node::Ptr>(item.second)) {
+          shards.push_back(&item.second);
+        }
       }
-      indices.push_back(index);
+      encoded = writes.flushConcurrently(
+          executor_, shards, [this](Node::Item &item, Writes &shard_writes) {
+            return flush(item, shard_writes);
+          });
+    }
+    if (encoded) {
+      encoded = flush(root_, writes);
+    }
+    if (!encoded) {
+      writes.unflush();
+      return encoded.error();
     }
-    return indices;
+    // nodes are replaced with CIDs only after all writes succeed
+    OUTCOME_TRY(writes.write([this](const CID &cid, Value bytes) {
+      return store_->set(cid, std::move(bytes));
+    }));
+    flushed_nodes_ = writes.size();
+    if (which<Node::Ptr>(root_)) {
+      root_ = *boost::get<Node::Ptr>(root_)->cid;
+    }
+    return boost::get<CID>(root_);
+  }
+
+  size_t Hamt::flushedNodes() const {
+    return flushed_nodes_;
+  }
+
+  void Hamt::setExecutor(common::Executor executor) {
+    executor_ = std::move(executor);
   }
 
   outcome::result<void> Hamt::set(Node &node,
-                                  gsl::span<const size_t> indices,
-                                  const std::string &key,
-                                  gsl::span<const uint8_t> value) {
-    if (indices.empty()) {
+                                  const HashPath &path,
+                                  std::string_view key,
+                                  gsl::span<const uint8_t> value,
+                                  boost::optional<Value> &old) {
+    if (path.empty()) {
       return HamtError::MAX_DEPTH;
     }
-    auto index = indices[0];
+    auto index = path.index();
     auto it = node.items.find(index);
     if (it == node.items.end()) {
       Node::Leaf leaf;
-      leaf.emplace(key, std::vector<uint8_t>(value.begin(), value.end()));
+      leaf.emplace(key, Value{value});
       node.items[index] = leaf;
+      node.cid = boost::none;
       return outcome::success();
     }
     auto &item = it->second;
     OUTCOME_TRY(loadItem(item));
     if (which<Node::Ptr>(item)) {
-      return set(
-          *boost::get<Node::Ptr>(item), consumeIndex(indices), key, value);
+      OUTCOME_TRY(set(mutableNode(item), path.next(), key, value, old));
+      node.cid = boost::none;
+      return outcome::success();
     }
     auto &leaf = boost::get<Node::Leaf>(item);
-    if (leaf.find(key) != leaf.end() || leaf.size() < kLeafMax) {
-      leaf[key] = Value(value);
+    auto found = leaf.find(key);
+    if (found != leaf.end()) {
+      old = std::move(found->second);
+      found->second = Value{value};
+    } else if (leaf.size() < kLeafMax) {
+      leaf.emplace(key, Value{value});
     } else {
+      // keys of leaf differ from key, so nothing is replaced
       auto child = std::make_shared<Node>();
-      OUTCOME_TRY(set(*child, consumeIndex(indices), key, value));
+      child->owner = owner_;
+      auto child_path = path.next();
+      OUTCOME_TRY(set(*child, child_path, key, value, old));
       for (auto &pair : leaf) {
-        auto indices2 = keyToIndices(pair.first, indices.size());
-        OUTCOME_TRY(set(*child, indices2, pair.first, pair.second));
+        OUTCOME_TRY(set(*child,
+                        child_path.forKey(pair.first),
+                        pair.first,
+                        pair.second,
+                        old));
       }
       item = child;
     }
+    node.cid = boost::none;
     return outcome::success();
   }
 
   outcome::result<void> Hamt::remove(Node &node,
-                                     gsl::span<const size_t> indices,
-                                     const std::string &key) {
-    if (indices.empty()) {
+                                     const HashPath &path,
+                                     std::string_view key) {
+    if (path.empty()) {
       return HamtError::MAX_DEPTH;
     }
-    auto index = indices[0];
+    auto index = path.index();
     auto it = node.items.find(index);
     if (it == node.items.end()) {
       return HamtError::NOT_FOUND;
@@ -165,8 +390,7 @@ namespace fc::storage::hamt {
     auto &item = it->second;
     OUTCOME_TRY(loadItem(item));
     if (which<Node::Ptr>(item)) {
-      OUTCOME_TRY(
-          remove(*boost::get<Node::Ptr>(item), consumeIndex(indices), key));
+      OUTCOME_TRY(remove(mutableNode(item), path.next(), key));
       OUTCOME_TRY(cleanShard(item));
     } else {
       auto &leaf = boost::get<Node::Leaf>(item);
@@ -179,6 +403,7 @@ namespace fc::storage::hamt {
         leaf.erase(key);
       }
     }
+    node.cid = boost::none;
     return outcome::success();
   }
 
@@ -187,7 +412,9 @@ namespace fc::storage::hamt {
     if (node.items.size() == 1) {
       auto &single_item = node.items.begin()->second;
       if (which<Node::Leaf>(single_item)) {
-        item = single_item;
+        // copy first, assignment releases node owning single item
+        auto leaf = boost::get<Node::Leaf>(single_item);
+        item = std::move(leaf);
       }
     } else if (node.items.size() <= kLeafMax) {
       Node::Leaf leaf;
@@ -196,7 +423,7 @@ namespace fc::storage::hamt {
           return outcome::success();
         }
         for (auto &pair : boost::get<Node::Leaf>(item2.second)) {
-          leaf.emplace(pair);
+          leaf.emplace(pair.first, pair.second);
           if (leaf.size() > kLeafMax) {
             return outcome::success();
           }
@@ -207,40 +434,209 @@ namespace fc::storage::hamt {
     return outcome::success();
   }
 
-  outcome::result<void> Hamt::flush(Node::Item &item) {
-    if (which<Node::Ptr>(item)) {
-      auto &node = *boost::get<Node::Ptr>(item);
+  Node &Hamt::mutableNode(Node::Item &item) const {
+    auto &ptr = boost::get<Node::Ptr>(item);
+    if (ptr->owner != owner_) {
+      ptr = std::make_shared<Node>(*ptr);
+    }
+    ptr->owner = owner_;
+    return *ptr;
+  }
+
+  outcome::result<void> Hamt::flush(Node::Item &item, Writes &writes) const {
+    if (which<Node::Ptr>(item) && !boost::get<Node::Ptr>(item)->cid) {
+      auto &node = mutableNode(item);
       for (auto &item2 : node.items) {
-        OUTCOME_TRY(flush(item2.second));
+        OUTCOME_TRY(flush(item2.second, writes));
       }
-      OUTCOME_TRY(cid, store_->setCbor(node));
-      item = cid;
+      OUTCOME_TRY(bytes, codec::cbor::encode(node));
+      OUTCOME_TRY(cid, common::getCidOf(bytes));
+      node.cid = cid;
+      writes.add(std::move(cid), Value{bytes}, node);
     }
     return outcome::success();
   }
 
+  outcome::result<Node::Ptr> Hamt::loadNode(const Node::Item &item,
+                                            uint64_t owner) const {
+    if (which<Node::Ptr>(item)) {
+      return boost::get<Node::Ptr>(item);
+    }
+    OUTCOME_TRY(loaded,
+                store_->getCborCached<Node>(
+                    boost::get<CID>(item),
+                    [](Node &node, const CID &cid) { node.cid = cid; }));
+    auto node = std::const_pointer_cast<Node>(loaded.value);
+    if (!loaded.cached) {
+      // not shared with decoded cache, so reads may store loaded children in it
+      node->owner = owner;
+    }
+    return node;
+  }
+
   outcome::result<void> Hamt::loadItem(Node::Item &item) const {
     if (which<CID>(item)) {
-      OUTCOME_TRY(child, store_->getCbor<Node>(boost::get<CID>(item)));
-      item = std::make_shared<Node>(std::move(child));
+      OUTCOME_TRY(node, loadNode(item, owner_));
+      item = std::move(node);
     }
     return outcome::success();
   }
 
-  outcome::result<void> Hamt::visit(const Visitor &visitor) {
-    return visit(root_, visitor);
+  outcome::result<Node::Ptr> Hamt::loadChild(Node &parent,
+                                             Node::Item &item) const {
+    // child of node shared with snapshots is reachable from them too
+    OUTCOME_TRY(node,
+                loadNode(item, parent.owner == owner_ ? owner_ : kSharedOwner));
+    if (parent.owner != kCacheOwner && which<CID>(item)) {
+      item = node;
+    }
+    return node;
   }
 
-  outcome::result<void> Hamt::visit(Node::Item &item, const Visitor &visitor) {
-    OUTCOME_TRY(loadItem(item));
-    if (which<Node::Ptr>(item)) {
-      for (auto &item2 : boost::get<Node::Ptr>(item)->items) {
-        OUTCOME_TRY(visit(item2.second, visitor));
+  outcome::result<std::vector<Node::Ptr>> Hamt::loadItems(Node &node,
+                                                          size_t begin,
+                                                          size_t end) const {
+    std::vector<Node::Ptr> children(end - begin);
+    std::vector<size_t> positions;
+    std::vector<CID> cids;
+    for (auto position = begin; position != end; ++position) {
+      auto &item = (node.items.begin() + position)->second;
+      if (which<CID>(item)) {
+        positions.push_back(position - begin);
+        cids.push_back(boost::get<CID>(item));
+      } else if (which<Node::Ptr>(item)) {
+        children[position - begin] = boost::get<Node::Ptr>(item);
       }
-    } else {
+    }
+    OUTCOME_TRY(loaded,
+                store_->getCborMany<Node>(
+                    cids, executor_, [](Node &child, const CID &cid) {
+                      child.cid = cid;
+                    }));
+    auto owner = node.owner == owner_ ? owner_ : kSharedOwner;
+    for (size_t i = 0; i < loaded.size(); ++i) {
+      auto child = std::const_pointer_cast<Node>(loaded[i].value);
+      if (!loaded[i].cached) {
+        child->owner = owner;
+      }
+      if (node.owner != kCacheOwner) {
+        (node.items.begin() + begin + positions[i])->second = child;
+      }
+      children[positions[i]] = std::move(child);
+    }
+    return children;
+  }
+
+  outcome::result<void> Hamt::diff(std::shared_ptr<ipfs::IpfsDatastore> store,
+                                   const CID &before,
+                                   const CID &after,
+                                   const DiffVisitor &visitor) {
+    Hamt hamt{std::move(store)};
+    return hamt.diff(Node::Item{before}, Node::Item{after}, visitor);
+  }
+
+  outcome::result<void> Hamt::visit(const Visitor &visitor) {
+    OUTCOME_TRY(loadItem(root_));
+    return visit(*boost::get<Node::Ptr>(root_), visitor);
+  }
+
+  outcome::result<void> Hamt::visit(const Node::Item &item,
+                                    const Visitor &visitor) {
+    if (which<Node::Leaf>(item)) {
       for (auto &pair : boost::get<Node::Leaf>(item)) {
         OUTCOME_TRY(visitor(pair.first, pair.second));
       }
+      return outcome::success();
+    }
+    OUTCOME_TRY(node, loadNode(item, kSharedOwner));
+    return visit(*node, visitor);
+  }
+
+  outcome::result<void> Hamt::visit(Node &node, const Visitor &visitor) {
+    OUTCOME_TRY(children, loadItems(node, 0, node.items.size()));
+    auto child = children.begin();
+    for (auto &item : node.items) {
+      if (*child) {
+        OUTCOME_TRY(visit(**child, visitor));
+      } else {
+        OUTCOME_TRY(visit(item.second, visitor));
+      }
+      ++child;
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> Hamt::diff(const Node::Item &before,
+                                   const Node::Item &after,
+                                   const DiffVisitor &visitor) {
+    if (cidOf(before) && cidOf(after) && *cidOf(before) == *cidOf(after)) {
+      return outcome::success();
+    }
+    if (!which<Node::Leaf>(before) && !which<Node::Leaf>(after)) {
+      OUTCOME_TRY(node_before, loadNode(before, kSharedOwner));
+      OUTCOME_TRY(node_after, loadNode(after, kSharedOwner));
+      return diff(*node_before, *node_after, visitor);
+    }
+    // at least one side is leaf, leaves are small so compare against it
+    auto before_is_leaf = which<Node::Leaf>(before);
+    auto leaf = boost::get<Node::Leaf>(before_is_leaf ? before : after);
+    auto &other = before_is_leaf ? after : before;
+    OUTCOME_TRY(visit(
+        other,
+        [&](auto &key, auto &value) -> outcome::result<void> {
+          auto it = leaf.find(key);
+          if (it == leaf.end()) {
+            if (before_is_leaf) {
+              return visitor({ChangeType::ADD, key, boost::none, value});
+            }
+            return visitor({ChangeType::REMOVE, key, value, boost::none});
+          }
+          if (it->second != value) {
+            if (before_is_leaf) {
+              OUTCOME_TRY(visitor({ChangeType::MODIFY, key, it->second, value}));
+            } else {
+              OUTCOME_TRY(visitor({ChangeType::MODIFY, key, value, it->second}));
+            }
+          }
+          leaf.erase(key);
+          return outcome::success();
+        }));
+    for (auto &pair : leaf) {
+      if (before_is_leaf) {
+        OUTCOME_TRY(visitor(
+            {ChangeType::REMOVE, pair.first, pair.second, boost::none}));
+      } else {
+        OUTCOME_TRY(
+            visitor({ChangeType::ADD, pair.first, boost::none, pair.second}));
+      }
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> Hamt::diff(Node &before,
+                                   Node &after,
+                                   const DiffVisitor &visitor) {
+    auto it_before = before.items.begin();
+    auto it_after = after.items.begin();
+    while (it_before != before.items.end() || it_after != after.items.end()) {
+      if (it_after == after.items.end()
+          || (it_before != before.items.end()
+              && it_before->first < it_after->first)) {
+        OUTCOME_TRY(visit(it_before->second, [&](auto &key, auto &value) {
+          return visitor({ChangeType::REMOVE, key, value, boost::none});
+        }));
+        ++it_before;
+      } else if (it_before == before.items.end()
+                 || it_after->first < it_before->first) {
+        OUTCOME_TRY(visit(it_after->second, [&](auto &key, auto &value) {
+          return visitor({ChangeType::ADD, key, boost::none, value});
+        }));
+        ++it_after;
+      } else {
+        OUTCOME_TRY(diff(it_before->second, it_after->second, visitor));
+        ++it_before;
+        ++it_after;
+      }
     }
     return outcome::success();
   }
@@ -6,72 +6,271 @@
 #ifndef CPP_FILECOIN_STORAGE_HAMT_HAMT_HPP
 #define CPP_FILECOIN_STORAGE_HAMT_HAMT_HPP
 
+#include <bitset>
 #include <string>
+#include <string_view>
 #include <vector>
 
-#include <boost/multiprecision/cpp_int.hpp>
+#include <boost/container/small_vector.hpp>
 #include <boost/variant.hpp>
 
 #include "codec/cbor/cbor.hpp"
 #include "codec/cbor/streams_annotation.hpp"
+#include "common/executor.hpp"
+#include "common/flush_writes.hpp"
 #include "common/outcome_throw.hpp"
 #include "common/visitor.hpp"
+#include "crypto/murmur/murmur.hpp"
 #include "primitives/cid/cid.hpp"
 #include "storage/ipfs/datastore.hpp"
 
 namespace fc::storage::hamt {
-  enum class HamtError { EXPECTED_CID = 1, NOT_FOUND, MAX_DEPTH };
+  enum class HamtError {
+    EXPECTED_CID = 1,
+    NOT_FOUND,
+    MAX_DEPTH,
+    INVALID_BIT_WIDTH
+  };
 }  // namespace fc::storage::hamt
 
 OUTCOME_HPP_DECLARE_ERROR(fc::storage::hamt, HamtError);
 
 namespace fc::storage::hamt {
-  using boost::multiprecision::cpp_int;
   using Value = ipfs::IpfsDatastore::Value;
 
   constexpr size_t kLeafMax = 3;
   constexpr size_t kDefaultBitWidth = 8;
+  /// Node bitmap has 2^kMaxBitWidth bits
+  constexpr size_t kMaxBitWidth = 8;
+
+  /**
+   * Check bit width of hamt
+   * @return bit width, raises INVALID_BIT_WIDTH if it is zero or greater than
+   * kMaxBitWidth
+   */
+  size_t checkBitWidth(size_t bit_width);
 
-  struct Bits : cpp_int {};
+  /// View bytes key as string key without copying
+  std::string_view keyView(gsl::span<const uint8_t> key);
+
+  /**
+   * Cursor over child indices on path of key from root, computed from key
+   * hash on demand without allocation. Index at each level is next bit width
+   * bits of hash, most significant first.
+   */
+  class HashPath {
+   public:
+    HashPath(std::string_view key, size_t bit_width);
+    HashPath(gsl::span<const uint8_t> key, size_t bit_width);
 
-  CBOR_ENCODE(Bits, bits) {
-    std::vector<uint8_t> bytes;
-    if (bits != 0) {
-      export_bits(bits, std::back_inserter(bytes), 8);
+    /** Returns child index at current level */
+    size_t index() const;
+
+    /** Returns count of levels left */
+    size_t size() const;
+
+    bool empty() const;
+
+    /** Returns cursor at next level */
+    HashPath next() const;
+
+    /** Returns cursor for other key at same level */
+    HashPath forKey(std::string_view key) const;
+    HashPath forKey(gsl::span<const uint8_t> key) const;
+
+    /** Returns key hash as big-endian integer, orders keys by path */
+    uint64_t hash() const;
+
+   private:
+    static_assert(sizeof(crypto::murmur::Hash) == sizeof(uint64_t));
+
+    uint64_t hash_;
+    size_t bit_width_;
+    size_t offset_{};
+  };
+
+  /**
+   * Sparse array of items with indices less than kMaxIndex.
+   * Present indices are marked in bitmap, position of item in contiguous
+   * vector is popcount of bitmap below its index.
+   */
+  template <typename T>
+  class SparseArray {
+   public:
+    static constexpr size_t kMaxIndex = size_t{1} << kMaxBitWidth;
+
+    using value_type = std::pair<size_t, T>;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    /** Checks if index is present */
+    bool has(size_t index) const {
+      return bitmap_[index / kWordBits] & bit(index);
     }
-    return s << bytes;
-  }
 
-  CBOR_DECODE(Bits, bits) {
-    std::vector<uint8_t> bytes;
-    s >> bytes;
-    if (bytes.empty()) {
-      bits = {0};
-    } else {
-      import_bits(bits, bytes.begin(), bytes.end());
+    /** Finds item by index */
+    iterator find(size_t index) {
+      return has(index) ? items_.begin() + rank(index) : items_.end();
+    }
+
+    /** Finds item by index */
+    const_iterator find(size_t index) const {
+      return has(index) ? items_.begin() + rank(index) : items_.end();
     }
-    return s;
-  }
+
+    /** Gets item by index, inserts default item if not present */
+    T &operator[](size_t index) {
+      auto position = rank(index);
+      if (!has(index)) {
+        bitmap_[index / kWordBits] |= bit(index);
+        items_.emplace(items_.begin() + position, index, T{});
+      }
+      return items_[position].second;
+    }
+
+    /** Removes item by index, returns count of removed items */
+    size_t erase(size_t index) {
+      if (!has(index)) {
+        return 0;
+      }
+      items_.erase(items_.begin() + rank(index));
+      bitmap_[index / kWordBits] &= ~bit(index);
+      return 1;
+    }
+
+    void clear() {
+      bitmap_.fill(0);
+      items_.clear();
+    }
+
+    void reserve(size_t size) {
+      items_.reserve(size);
+    }
+
+    size_t size() const {
+      return items_.size();
+    }
+
+    bool empty() const {
+      return items_.empty();
+    }
+
+    iterator begin() {
+      return items_.begin();
+    }
+
+    iterator end() {
+      return items_.end();
+    }
+
+    const_iterator begin() const {
+      return items_.begin();
+    }
+
+    const_iterator end() const {
+      return items_.end();
+    }
+
+    /** Returns bitmap as big-endian bytes without leading zeros */
+    std::vector<uint8_t> bitfield() const {
+      std::vector<uint8_t> bytes;
+      for (auto byte = kMaxIndex / 8; byte != 0; --byte) {
+        auto word = bitmap_[(byte - 1) * 8 / kWordBits];
+        uint8_t value = word >> ((byte - 1) * 8 % kWordBits);
+        if (value != 0 || !bytes.empty()) {
+          bytes.push_back(value);
+        }
+      }
+      return bytes;
+    }
+
+   private:
+    static constexpr size_t kWordBits = 64;
+
+    static uint64_t bit(size_t index) {
+      return uint64_t{1} << (index % kWordBits);
+    }
+
+    /** Count of present indices less than index */
+    size_t rank(size_t index) const {
+      size_t count = 0;
+      for (size_t word = 0; word < index / kWordBits; ++word) {
+        count += std::bitset<kWordBits>(bitmap_[word]).count();
+      }
+      return count
+             + std::bitset<kWordBits>(bitmap_[index / kWordBits]
+                                      & (bit(index) - 1))
+                   .count();
+    }
+
+    std::array<uint64_t, kMaxIndex / kWordBits> bitmap_{};
+    std::vector<value_type> items_;
+  };
 
   /** Hamt node representation */
   struct Node {
     using Ptr = std::shared_ptr<Node>;
-    using Leaf = std::map<std::string, Value>;
+
+    /// Key-value pairs sorted by key, stored inline up to kLeafMax pairs
+    class Leaf {
+     public:
+      using value_type = std::pair<std::string, Value>;
+      using Pairs = boost::container::small_vector<value_type, kLeafMax>;
+      using iterator = Pairs::iterator;
+      using const_iterator = Pairs::const_iterator;
+
+      Leaf() = default;
+      Leaf(std::initializer_list<value_type> pairs);
+
+      iterator find(std::string_view key);
+      const_iterator find(std::string_view key) const;
+      iterator find(gsl::span<const uint8_t> key);
+      const_iterator find(gsl::span<const uint8_t> key) const;
+      /** Gets value by key, inserts empty value if not present */
+      Value &operator[](std::string_view key);
+      /** Inserts value if key is not present */
+      std::pair<iterator, bool> emplace(std::string_view key, Value value);
+      /** Removes value by key, returns count of removed values */
+      size_t erase(std::string_view key);
+
+      size_t size() const;
+      bool empty() const;
+      iterator begin();
+      iterator end();
+      const_iterator begin() const;
+      const_iterator end() const;
+
+     private:
+      Pairs pairs_;
+    };
+
     using Item = boost::variant<CID, Ptr, Leaf>;
 
-    std::map<size_t, Item> items;
+    SparseArray<Item> items;
+    /// CID node was loaded from or flushed to, reset on modification, not
+    /// encoded
+    boost::optional<CID> cid;
+    /**
+     * Token of hamt version allowed to modify node in place, zero if node
+     * may be shared with decoded cache, not encoded
+     */
+    uint64_t owner{};
   };
 
   CBOR_ENCODE(Node, node) {
     auto l_items = s.list();
-    Bits bits;
     for (auto &item : node.items) {
-      bit_set(bits, item.first);
       auto m_item = s.map();
       visit_in_place(
           item.second,
           [&m_item](const CID &cid) { m_item["0"] << cid; },
-          [](const Node::Ptr &ptr) { outcome::raise(HamtError::EXPECTED_CID); },
+          [&m_item](const Node::Ptr &ptr) {
+            // unmodified node is encoded as link to it
+            if (!ptr || !ptr->cid) {
+              outcome::raise(HamtError::EXPECTED_CID);
+            }
+            m_item["0"] << *ptr->cid;
+          },
           [&m_item](const Node::Leaf &leaf) {
             auto &s_leaf = m_item["1"];
             auto l_pairs = s_leaf.list();
@@ -83,117 +282,275 @@ namespace fc::storage::hamt {
           });
       l_items << m_item;
     }
-    return s << (s.list() << bits << l_items);
+    return s << (s.list() << node.items.bitfield() << l_items);
   }
 
   CBOR_DECODE(Node, node) {
     node.items.clear();
     auto l_node = s.list();
-    Bits bits;
+    std::vector<uint8_t> bits;
     l_node >> bits;
     auto n_items = l_node.listLength();
     auto l_items = l_node.list();
-    size_t j = 0;
-    for (size_t i = 0; i < n_items; ++i) {
-      while (!bit_test(bits, j)) {
-        ++j;
+    node.items.reserve(n_items);
+    size_t i = 0;
+    for (size_t j = 0; j < bits.size() * 8; ++j) {
+      if (!(bits[bits.size() - 1 - j / 8] & (1 << (j % 8)))) {
+        continue;
       }
-      auto m_item = l_items.map();
-      if (m_item.find("0") != m_item.end()) {
-        CID cid;
-        m_item.at("0") >> cid;
-        node.items[j] = std::move(cid);
-      } else {
-        auto s_leaf = m_item.at("1");
-        auto n_leaf = s_leaf.listLength();
-        auto l_leaf = s_leaf.list();
-        Node::Leaf leaf;
-        for (size_t j = 0; j < n_leaf; ++j) {
-          auto l_pair = l_leaf.list();
-          std::string key;
-          l_pair >> key;
-          leaf.emplace(key, l_pair.raw());
+      if (i == n_items || j >= SparseArray<Node::Item>::kMaxIndex) {
+        outcome::raise(codec::cbor::CborDecodeError::WRONG_SIZE);
+      }
+      // pointer is map with "0" for link or "1" for bucket of pairs
+      auto n_entries = l_items.mapLength();
+      auto m_item = l_items.mapEntries();
+      auto found = false;
+      for (size_t k = 0; k < n_entries; ++k) {
+        std::string_view kind;
+        m_item >> kind;
+        if (found || (kind != "0" && kind != "1")) {
+          m_item.next();
+          continue;
+        }
+        found = true;
+        if (kind == "0") {
+          CID cid;
+          m_item >> cid;
+          node.items[j] = std::move(cid);
+        } else {
+          auto n_leaf = m_item.listLength();
+          auto l_leaf = m_item.list();
+          Node::Leaf leaf;
+          for (size_t l = 0; l < n_leaf; ++l) {
+            auto l_pair = l_leaf.list();
+            std::string_view key;
+            l_pair >> key;
+            leaf.emplace(key, Value{l_pair.rawView()});
+          }
+          node.items[j] = std::move(leaf);
         }
-        node.items[j] = std::move(leaf);
       }
-      ++j;
+      if (!found) {
+        outcome::raise(codec::cbor::CborDecodeError::INVALID_CBOR);
+      }
+      ++i;
+    }
+    if (i != n_items) {
+      outcome::raise(codec::cbor::CborDecodeError::WRONG_SIZE);
     }
     return s;
   }
 
+  /// Kind of key change between two hamt roots
+  enum class ChangeType { ADD, REMOVE, MODIFY };
+
+  /// Key change between two hamt roots
+  struct Change {
+    ChangeType type;
+    std::string key;
+    /// Value before change, empty for ADD
+    boost::optional<Value> before;
+    /// Value after change, empty for REMOVE
+    boost::optional<Value> after;
+  };
+
   /**
    * Hamt map
    * https://github.com/ipld/specs/blob/c1b0d3f4dc26850071d0e4d67854408e970ed29c/data-structures/hashmap.md
+   *
+   * Snapshots of hamt share nodes. Modification copies nodes on path from
+   * root which are shared with other snapshots, so taking snapshot is O(1)
+   * and snapshots are independent.
    */
   class Hamt {
    public:
     using Visitor = std::function<outcome::result<void>(const std::string &,
                                                         const Value &)>;
+    using DiffVisitor = std::function<outcome::result<void>(const Change &)>;
 
+    /// Raises INVALID_BIT_WIDTH if bit width is not supported
     Hamt(std::shared_ptr<ipfs::IpfsDatastore> store,
          size_t bit_width = kDefaultBitWidth);
     Hamt(std::shared_ptr<ipfs::IpfsDatastore> store, Node::Ptr root);
+    /// Raises INVALID_BIT_WIDTH if bit width is not supported
     Hamt(std::shared_ptr<ipfs::IpfsDatastore> store,
          const CID &root,
          size_t bit_width = kDefaultBitWidth);
+    Hamt(Hamt &&other) = default;
+    Hamt &operator=(const Hamt &other) = delete;
+    Hamt &operator=(Hamt &&other) = default;
+
+    /**
+     * Take O(1) snapshot sharing nodes with this hamt. Neither modifies
+     * shared nodes afterwards, so this hamt stops modifying its nodes in
+     * place too, which is why snapshot is not const. Reads of either store
+     * loaded nodes in shared ones, so they must not be used concurrently.
+     */
+    Hamt snapshot();
+
     /** Set value by key, does not write to storage */
-    outcome::result<void> set(const std::string &key,
+    outcome::result<void> set(std::string_view key,
+                              gsl::span<const uint8_t> value);
+    outcome::result<void> set(gsl::span<const uint8_t> key,
                               gsl::span<const uint8_t> value);
 
+    /**
+     * Set value by key in one lookup, does not write to storage
+     * @return replaced value, none if key was not present
+     */
+    outcome::result<boost::optional<Value>> exchange(
+        std::string_view key, gsl::span<const uint8_t> value);
+
     /** Get value by key */
-    outcome::result<Value> get(const std::string &key);
+    outcome::result<Value> get(std::string_view key);
+    outcome::result<Value> get(gsl::span<const uint8_t> key);
 
     /**
      * Remove value by key, does not write to storage.
      * Returns NOT_FOUND if element doesn't exist.
      */
-    outcome::result<void> remove(const std::string &key);
+    outcome::result<void> remove(std::string_view key);
+    outcome::result<void> remove(gsl::span<const uint8_t> key);
 
     /**
      * Checks if key is present
      */
-    outcome::result<bool> contains(const std::string &key);
+    outcome::result<bool> contains(std::string_view key);
+    outcome::result<bool> contains(gsl::span<const uint8_t> key);
 
     /**
-     * Write changes made by set and remove to storage
+     * Write changes made by set and remove to storage.
+     * Only nodes modified since load are encoded and written, unchanged nodes
+     * keep CID they were loaded from.
      * @return new root
      */
     outcome::result<CID> flush();
 
-    /** Apply visitor for key value pairs */
+    /** Returns count of nodes written to storage by last flush */
+    size_t flushedNodes() const;
+
+    /**
+     * Set executor for flush and visit. Flush encodes modified shards of root
+     * node concurrently, visit decodes all linked shards of node in one batch
+     * before descending into them.
+     * @param executor - executor, empty to flush and load serially
+     */
+    void setExecutor(common::Executor executor);
+
+    /**
+     * Apply visitor for key value pairs. Children of each node are loaded in
+     * one batch before descending into first of them.
+     */
     outcome::result<void> visit(const Visitor &visitor);
 
+    /**
+     * Stream changes needed to turn hamt with root "before" into hamt with
+     * root "after". Both tries are walked in lockstep, subtrees with equal
+     * CIDs are skipped without loading.
+     * @param store - storage containing both hamts
+     * @param before - old root
+     * @param after - new root
+     * @param visitor - called for each changed key
+     */
+    static outcome::result<void> diff(
+        std::shared_ptr<ipfs::IpfsDatastore> store,
+        const CID &before,
+        const CID &after,
+        const DiffVisitor &visitor);
+
     /// Store CBOR encoded value by key
     template <typename T>
-    outcome::result<void> setCbor(const std::string &key, const T &value) {
+    outcome::result<void> setCbor(std::string_view key, const T &value) {
       OUTCOME_TRY(bytes, codec::cbor::encode(value));
       return set(key, bytes);
     }
 
+    /// Store CBOR encoded value by bytes key
+    template <typename T>
+    outcome::result<void> setCbor(gsl::span<const uint8_t> key,
+                                  const T &value) {
+      return setCbor(keyView(key), value);
+    }
+
     /// Get CBOR decoded value by key
     template <typename T>
-    outcome::result<T> getCbor(const std::string &key) {
+    outcome::result<T> getCbor(std::string_view key) {
       OUTCOME_TRY(bytes, get(key));
       return codec::cbor::decode<T>(bytes);
     }
 
+    /// Get CBOR decoded value by bytes key
+    template <typename T>
+    outcome::result<T> getCbor(gsl::span<const uint8_t> key) {
+      return getCbor<T>(keyView(key));
+    }
+
    private:
-    std::vector<size_t> keyToIndices(const std::string &key, int n = -1) const;
+    friend class HamtCursor;
+
     outcome::result<void> set(Node &node,
-                              gsl::span<const size_t> indices,
-                              const std::string &key,
-                              gsl::span<const uint8_t> value);
+                              const HashPath &path,
+                              std::string_view key,
+                              gsl::span<const uint8_t> value,
+                              boost::optional<Value> &old);
     outcome::result<void> remove(Node &node,
-                                 gsl::span<const size_t> indices,
-                                 const std::string &key);
+                                 const HashPath &path,
+                                 std::string_view key);
     static outcome::result<void> cleanShard(Node::Item &item);
-    outcome::result<void> flush(Node::Item &item);
+    using Writes = common::FlushWrites<CID, Node>;
+
+    /**
+     * Get node of item for modification. Node not owned by this version of
+     * hamt is copied, so modifications copy path from root and never affect
+     * decoded cache or other versions.
+     */
+    Node &mutableNode(Node::Item &item) const;
+    outcome::result<void> flush(Node::Item &item, Writes &writes) const;
+    /**
+     * Get node of item, loading it if item is CID. Loaded node may be shared
+     * with decoded cache, so it is modified only through mutableNode.
+     * @param owner - owner of loaded node if it is not shared with cache
+     */
+    outcome::result<Node::Ptr> loadNode(const Node::Item &item,
+                                        uint64_t owner) const;
+    /// Load node of item and store it in item, item must not be shared
     outcome::result<void> loadItem(Node::Item &item) const;
-    outcome::result<void> visit(Node::Item &item, const Visitor &visitor);
+    /**
+     * Load node of parent's item, item must not be leaf. Node is stored in
+     * item unless parent may be shared with decoded cache. Storing loaded
+     * node does not change content of parent, so it is done in nodes shared
+     * with snapshots too, and later reads of any snapshot reuse it. Node
+     * stored in parent not owned by this hamt is not owned by any version.
+     */
+    outcome::result<Node::Ptr> loadChild(Node &parent, Node::Item &item) const;
+    /**
+     * Load children of node at item positions [begin, end) in one batch,
+     * stored like loadChild
+     * @return nodes in order of items, nullptr for leaves
+     */
+    outcome::result<std::vector<Node::Ptr>> loadItems(Node &node,
+                                                      size_t begin,
+                                                      size_t end) const;
+    outcome::result<void> visit(const Node::Item &item,
+                                const Visitor &visitor);
+    outcome::result<void> visit(Node &node, const Visitor &visitor);
+    outcome::result<void> diff(const Node::Item &before,
+                               const Node::Item &after,
+                               const DiffVisitor &visitor);
+    outcome::result<void> diff(Node &before,
+                               Node &after,
+                               const DiffVisitor &visitor);
+
+    /// Copy shares nodes and owner, used only by snapshot
+    Hamt(const Hamt &other) = default;
 
     std::shared_ptr<ipfs::IpfsDatastore> store_;
     Node::Item root_;
     size_t bit_width_;
+    size_t flushed_nodes_{};
+    common::Executor executor_;
+    /// Changed on snapshot, so nodes shared with it are not modified in place
+    uint64_t owner_;
   };
 }  // namespace fc::storage::hamt
 
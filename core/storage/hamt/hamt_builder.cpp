@@ -0,0 +1,78 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/hamt/hamt_builder.hpp"
+
+#include <algorithm>
+
+namespace fc::storage::hamt {
+
+  HamtBuilder::HamtBuilder(std::shared_ptr<ipfs::IpfsDatastore> store,
+                           size_t bit_width)
+      : store_{std::move(store)}, bit_width_{checkBitWidth(bit_width)} {}
+
+  void HamtBuilder::add(std::string_view key,
+                        gsl::span<const uint8_t> value) {
+    entries_.push_back(
+        {HashPath{key, bit_width_}, std::string{key}, Value{value}});
+  }
+
+  outcome::result<CID> HamtBuilder::build() {
+    written_nodes_ = 0;
+    auto entries = std::move(entries_);
+    entries_.clear();
+    // stable, so last added value of duplicate key is last in its run
+    std::stable_sort(entries.begin(), entries.end(), [](auto &lhs, auto &rhs) {
+      if (lhs.path.hash() != rhs.path.hash()) {
+        return lhs.path.hash() < rhs.path.hash();
+      }
+      return lhs.key < rhs.key;
+    });
+    auto last = std::unique(
+        entries.rbegin(), entries.rend(), [](auto &lhs, auto &rhs) {
+          return lhs.key == rhs.key;
+        });
+    entries.erase(entries.begin(), last.base());
+    OUTCOME_TRY(root, build(entries.begin(), entries.end()));
+    OUTCOME_TRY(cid, store_->setCbor(root));
+    ++written_nodes_;
+    return std::move(cid);
+  }
+
+  size_t HamtBuilder::writtenNodes() const {
+    return written_nodes_;
+  }
+
+  outcome::result<Node> HamtBuilder::build(Iterator begin, Iterator end) {
+    Node node;
+    while (begin != end) {
+      auto index = begin->path.index();
+      auto group_end = std::find_if(begin, end, [index](auto &entry) {
+        return entry.path.index() != index;
+      });
+      if (static_cast<size_t>(group_end - begin) <= kLeafMax) {
+        Node::Leaf leaf;
+        for (auto it = begin; it != group_end; ++it) {
+          leaf.emplace(it->key, std::move(it->value));
+        }
+        node.items[index] = std::move(leaf);
+      } else {
+        if (begin->path.next().empty()) {
+          return HamtError::MAX_DEPTH;
+        }
+        for (auto it = begin; it != group_end; ++it) {
+          it->path = it->path.next();
+        }
+        OUTCOME_TRY(child, build(begin, group_end));
+        OUTCOME_TRY(cid, store_->setCbor(child));
+        ++written_nodes_;
+        node.items[index] = std::move(cid);
+      }
+      begin = group_end;
+    }
+    return std::move(node);
+  }
+
+}  // namespace fc::storage::hamt
@@ -0,0 +1,64 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_STORAGE_HAMT_HAMT_BUILDER_HPP
+#define CPP_FILECOIN_STORAGE_HAMT_HAMT_BUILDER_HPP
+
+#include "storage/hamt/hamt.hpp"
+
+namespace fc::storage::hamt {
+
+  /**
+   * Builds hamt from unsorted key-value pairs in one pass.
+   * Pairs are bucketed by key hash and nodes are encoded bottom-up, so each
+   * node is written to storage exactly once. Resulting root is same as after
+   * setting all pairs to empty hamt and flushing it.
+   */
+  class HamtBuilder {
+   public:
+    /// Raises INVALID_BIT_WIDTH if bit width is not supported
+    explicit HamtBuilder(std::shared_ptr<ipfs::IpfsDatastore> store,
+                         size_t bit_width = kDefaultBitWidth);
+
+    /** Add key-value pair, replaces value added earlier for same key */
+    void add(std::string_view key, gsl::span<const uint8_t> value);
+
+    /// Add CBOR encoded value by key
+    template <typename T>
+    outcome::result<void> addCbor(std::string_view key, const T &value) {
+      OUTCOME_TRY(bytes, codec::cbor::encode(value));
+      add(key, bytes);
+      return outcome::success();
+    }
+
+    /**
+     * Write nodes to storage and clear added pairs
+     * @return root of hamt
+     */
+    outcome::result<CID> build();
+
+    /** Returns count of nodes written to storage by last build */
+    size_t writtenNodes() const;
+
+   private:
+    struct Entry {
+      HashPath path;
+      std::string key;
+      Value value;
+    };
+    using Iterator = std::vector<Entry>::iterator;
+
+    /// Build node from entries with paths at level of node
+    outcome::result<Node> build(Iterator begin, Iterator end);
+
+    std::shared_ptr<ipfs::IpfsDatastore> store_;
+    size_t bit_width_;
+    std::vector<Entry> entries_;
+    size_t written_nodes_{};
+  };
+
+}  // namespace fc::storage::hamt
+
+#endif  // CPP_FILECOIN_STORAGE_HAMT_HAMT_BUILDER_HPP
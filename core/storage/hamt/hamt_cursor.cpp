@@ -0,0 +1,111 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/hamt/hamt_cursor.hpp"
+
+#include "common/which.hpp"
+
+namespace fc::storage::hamt {
+  using common::which;
+
+  HamtCursor::HamtCursor(Hamt &hamt, size_t prefetch)
+      : hamt_{hamt}, prefetch_{prefetch} {}
+
+  outcome::result<bool> HamtCursor::next() {
+    if (!started_) {
+      OUTCOME_TRY(start());
+      stack_.push_back({boost::get<Node::Ptr>(hamt_.root_)});
+    }
+    while (true) {
+      if (leaf_ && next_pair_ < leaf_->size()) {
+        current_ = &*(leaf_->begin() + next_pair_);
+        ++next_pair_;
+        return true;
+      }
+      leaf_ = nullptr;
+      if (stack_.empty()) {
+        return false;
+      }
+      auto &frame = stack_.back();
+      auto node = frame.node;
+      if (frame.next == node->items.size()) {
+        stack_.pop_back();
+        continue;
+      }
+      if (frame.next >= frame.loaded) {
+        frame.loaded =
+            std::min(node->items.size(), frame.next + 1 + prefetch_);
+        OUTCOME_TRY(children,
+                    hamt_.loadItems(*node, frame.next, frame.loaded));
+        frame.children.resize(node->items.size());
+        std::move(children.begin(),
+                  children.end(),
+                  frame.children.begin() + frame.next);
+      }
+      auto &item = (node->items.begin() + frame.next)->second;
+      auto &child = frame.children[frame.next];
+      ++frame.next;
+      if (child) {
+        // move out, stack_ reallocation invalidates frame
+        stack_.push_back({std::move(child)});
+      } else {
+        leaf_ = &boost::get<Node::Leaf>(item);
+        next_pair_ = 0;
+      }
+    }
+  }
+
+  outcome::result<void> HamtCursor::seekAfter(std::string_view key) {
+    OUTCOME_TRY(start());
+    auto node = boost::get<Node::Ptr>(hamt_.root_);
+    for (HashPath path{key, hamt_.bit_width_}; !path.empty();
+         path = path.next()) {
+      auto index = path.index();
+      auto it = std::lower_bound(
+          node->items.begin(),
+          node->items.end(),
+          index,
+          [](auto &item, auto index) { return item.first < index; });
+      size_t position = it - node->items.begin();
+      if (it == node->items.end() || it->first != index) {
+        stack_.push_back({node, position, position});
+        return outcome::success();
+      }
+      stack_.push_back({node, position + 1, position + 1});
+      if (!which<Node::Leaf>(it->second)) {
+        OUTCOME_TRY(child, hamt_.loadChild(*node, it->second));
+        node = std::move(child);
+      } else {
+        leaf_ = &boost::get<Node::Leaf>(it->second);
+        next_pair_ = std::upper_bound(leaf_->begin(),
+                                      leaf_->end(),
+                                      key,
+                                      [](auto key, auto &pair) {
+                                        return key < pair.first;
+                                      })
+                     - leaf_->begin();
+        return outcome::success();
+      }
+    }
+    return HamtError::MAX_DEPTH;
+  }
+
+  const std::string &HamtCursor::key() const {
+    return current_->first;
+  }
+
+  const Value &HamtCursor::value() const {
+    return current_->second;
+  }
+
+  outcome::result<void> HamtCursor::start() {
+    started_ = true;
+    stack_.clear();
+    leaf_ = nullptr;
+    current_ = nullptr;
+    return hamt_.loadItem(hamt_.root_);
+  }
+
+}  // namespace fc::storage::hamt
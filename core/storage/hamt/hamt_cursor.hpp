@@ -0,0 +1,79 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_STORAGE_HAMT_HAMT_CURSOR_HPP
+#define CPP_FILECOIN_STORAGE_HAMT_HAMT_CURSOR_HPP
+
+#include "storage/hamt/hamt.hpp"
+
+namespace fc::storage::hamt {
+
+  /**
+   * Lazy iterator over key-value pairs of hamt in hash order.
+   * Nodes are loaded on demand, so iteration may stop early without loading
+   * rest of trie. Hamt must not be modified while cursor is used.
+   *
+   * @code
+   * HamtCursor cursor{hamt};
+   * while (true) {
+   *   OUTCOME_TRY(found, cursor.next());
+   *   if (!found) break;
+   *   use(cursor.key(), cursor.value());
+   * }
+   * @endcode
+   */
+  class HamtCursor {
+   public:
+    /**
+     * @param hamt - hamt to iterate
+     * @param prefetch - count of following sibling items to load in one
+     * batch with each loaded node, decoded concurrently by hamt executor
+     */
+    explicit HamtCursor(Hamt &hamt, size_t prefetch = 0);
+
+    /**
+     * Advance to next pair
+     * @return false if there are no more pairs
+     */
+    outcome::result<bool> next();
+
+    /**
+     * Position cursor after key, so next pair is first one following it.
+     * Used to resume iteration from key of last pair seen, key doesn't need
+     * to be present in hamt.
+     */
+    outcome::result<void> seekAfter(std::string_view key);
+
+    /** Key of current pair */
+    const std::string &key() const;
+
+    /** Value of current pair */
+    const Value &value() const;
+
+   private:
+    struct Frame {
+      Node::Ptr node;
+      /// Position of next item to visit
+      size_t next{};
+      /// Position of first item not loaded yet
+      size_t loaded{};
+      /// Loaded child nodes by item position, node itself may be shared
+      std::vector<Node::Ptr> children{};
+    };
+
+    outcome::result<void> start();
+
+    Hamt &hamt_;
+    size_t prefetch_;
+    bool started_{};
+    std::vector<Frame> stack_;
+    const Node::Leaf *leaf_{};
+    size_t next_pair_{};
+    const Node::Leaf::value_type *current_{};
+  };
+
+}  // namespace fc::storage::hamt
+
+#endif  // CPP_FILECOIN_STORAGE_HAMT_HAMT_CURSOR_HPP
@@ -6,10 +6,12 @@
 #ifndef CPP_FILECOIN_CORE_STORAGE_IPFS_DATASTORE_HPP
 #define CPP_FILECOIN_CORE_STORAGE_IPFS_DATASTORE_HPP
 
+#include <typeindex>
 #include <vector>
 
 #include "codec/cbor/cbor.hpp"
 #include "common/buffer.hpp"
+#include "common/executor.hpp"
 #include "common/logger.hpp"
 #include "common/outcome.hpp"
 #include "primitives/cid/cid.hpp"
@@ -17,10 +19,20 @@
 
 namespace fc::storage::ipfs {
 
+  /**
+   * Content addressed key-value storage. Implementations are not required to
+   * be thread-safe, so callers must not access one datastore concurrently.
+   */
   class IpfsDatastore {
    public:
     using Value = common::Buffer;
 
+    /// Immutable object decoded from value as type
+    struct DecodedObject {
+      std::type_index type;
+      std::shared_ptr<const void> value;
+    };
+
     virtual ~IpfsDatastore() = default;
 
     /**
@@ -71,6 +83,131 @@ namespace fc::storage::ipfs {
       OUTCOME_TRY(bytes, get(key));
       return codec::cbor::decode<T>(bytes);
     }
+
+    /**
+     * Called on freshly decoded value before it is shared, e.g. to remember
+     * CID it was loaded from. Must depend only on value and CID, because
+     * cached value is shared by all callers decoding same type.
+     */
+    template <typename T>
+    using OnDecoded = std::function<void(T &, const CID &)>;
+
+    /// Value returned by getCborCached
+    template <typename T>
+    struct Decoded {
+      std::shared_ptr<const T> value;
+      /**
+       * Value is held by decoded cache and must be copied for modification.
+       * Otherwise caller holds the only reference and may modify it, values
+       * are allocated non-const.
+       */
+      bool cached{};
+    };
+
+    /**
+     * @brief Get CBOR decoded value by CID, reuses object decoded earlier if
+     * datastore caches decoded objects (see CachedDatastore).
+     * @param key - CID of value
+     * @param on_decoded - called on value decoded from storage
+     * @return decoded value and whether it is shared with cache
+     */
+    template <typename T>
+    outcome::result<Decoded<T>> getCborCached(
+        const CID &key, const OnDecoded<T> &on_decoded = {}) const {
+      if (auto cached = getDecoded(key, typeid(T))) {
+        return Decoded<T>{std::static_pointer_cast<const T>(cached), true};
+      }
+      OUTCOME_TRY(bytes, get(key));
+      OUTCOME_TRY(decoded, codec::cbor::decode<T>(bytes));
+      auto value = std::make_shared<T>(std::move(decoded));
+      if (on_decoded) {
+        on_decoded(*value, key);
+      }
+      auto cached = putDecoded(key, {typeid(T), value}, bytes.size());
+      return Decoded<T>{std::move(value), cached};
+    }
+
+    /**
+     * @brief Get CBOR decoded values by CIDs in one batch, reusing decoded
+     * cache like getCborCached. Values are fetched by calling thread, only
+     * decoding runs concurrently, because datastore reads are not
+     * thread-safe.
+     * @param keys - CIDs of values
+     * @param executor - executor to decode values concurrently, may be empty
+     * @param on_decoded - called on values decoded from storage, concurrently
+     * @return decoded values in order of keys, or first error
+     */
+    template <typename T>
+    outcome::result<std::vector<Decoded<T>>> getCborMany(
+        gsl::span<const CID> keys,
+        const common::Executor &executor,
+        const OnDecoded<T> &on_decoded = {}) const {
+      std::vector<Decoded<T>> values(keys.size());
+      std::vector<Value> bytes(keys.size());
+      std::vector<size_t> pending;
+      for (size_t i = 0; i < values.size(); ++i) {
+        if (auto cached = getDecoded(keys[i], typeid(T))) {
+          values[i] = {std::static_pointer_cast<const T>(cached), true};
+          continue;
+        }
+        OUTCOME_TRY(value, get(keys[i]));
+        bytes[i] = std::move(value);
+        pending.push_back(i);
+      }
+      std::vector<outcome::result<void>> results(pending.size(),
+                                                 outcome::success());
+      std::vector<std::function<void()>> tasks;
+      for (size_t j = 0; j < pending.size(); ++j) {
+        tasks.emplace_back([&, j] {
+          auto i = pending[j];
+          auto decoded = codec::cbor::decode<T>(bytes[i]);
+          if (!decoded) {
+            results[j] = decoded.error();
+            return;
+          }
+          auto value = std::make_shared<T>(std::move(decoded.value()));
+          if (on_decoded) {
+            on_decoded(*value, keys[i]);
+          }
+          values[i].value = std::move(value);
+        });
+      }
+      common::runTasks(executor, std::move(tasks));
+      for (auto &result : results) {
+        OUTCOME_TRY(result);
+      }
+      for (auto i : pending) {
+        values[i].cached = putDecoded(
+            keys[i], {typeid(T), values[i].value}, bytes[i].size());
+      }
+      return values;
+    }
+
+   protected:
+    /**
+     * @brief Get object decoded earlier from value stored in this datastore,
+     * datastore without cache always returns nullptr
+     * @param key - CID of value
+     * @param type - decoded type
+     * @return decoded object or nullptr
+     */
+    virtual std::shared_ptr<const void> getDecoded(
+        const CID &key, const std::type_index &type) const {
+      return nullptr;
+    }
+
+    /**
+     * @brief Remember object decoded from value stored in this datastore
+     * @param key - CID of value
+     * @param object - decoded object
+     * @param size - encoded size of value
+     * @return true if object is kept and shared with later callers
+     */
+    virtual bool putDecoded(const CID &key,
+                            DecodedObject object,
+                            size_t size) const {
+      return false;
+    }
   };
 }  // namespace fc::storage::ipfs
 
@@ -0,0 +1,51 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/cached_datastore.hpp"
+
+namespace fc::storage::ipfs {
+
+  CachedDatastore::CachedDatastore(std::shared_ptr<IpfsDatastore> store,
+                                   size_t cache_size)
+      : store_{std::move(store)}, cache_{cache_size} {}
+
+  outcome::result<bool> CachedDatastore::contains(const CID &key) const {
+    return store_->contains(key);
+  }
+
+  outcome::result<void> CachedDatastore::set(const CID &key, Value value) {
+    return store_->set(key, std::move(value));
+  }
+
+  outcome::result<IpfsDatastore::Value> CachedDatastore::get(
+      const CID &key) const {
+    return store_->get(key);
+  }
+
+  outcome::result<void> CachedDatastore::remove(const CID &key) {
+    cache_.erase(key);
+    return store_->remove(key);
+  }
+
+  CachedDatastore::Cache::Stats CachedDatastore::cacheStats() const {
+    return cache_.stats();
+  }
+
+  std::shared_ptr<const void> CachedDatastore::getDecoded(
+      const CID &key, const std::type_index &type) const {
+    auto cached = cache_.get(key);
+    if (!cached || cached->type != type) {
+      return nullptr;
+    }
+    return cached->value;
+  }
+
+  bool CachedDatastore::putDecoded(const CID &key,
+                                   DecodedObject object,
+                                   size_t size) const {
+    return cache_.put(key, std::move(object), size);
+  }
+
+}  // namespace fc::storage::ipfs
@@ -0,0 +1,64 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_IPFS_IMPL_CACHED_DATASTORE_HPP
+#define CPP_FILECOIN_IPFS_IMPL_CACHED_DATASTORE_HPP
+
+#include "common/lru_cache.hpp"
+#include "storage/ipfs/datastore.hpp"
+
+namespace fc::storage::ipfs {
+
+  /**
+   * Datastore decorator keeping objects decoded by getCborCached and
+   * getCborMany. Cache belongs to this decorator only, so cached objects are
+   * always backed by values of wrapped datastore, and remove evicts them.
+   * Wrapped datastore must not be modified bypassing decorator. Entries are
+   * charged with encoded size of value, so cache limit bounds encoded bytes,
+   * not decoded memory.
+   */
+  class CachedDatastore : public IpfsDatastore {
+   public:
+    using Cache = common::LruCache<CID, DecodedObject>;
+
+    /**
+     * @param store - wrapped datastore
+     * @param cache_size - max total encoded size of cached objects
+     */
+    CachedDatastore(std::shared_ptr<IpfsDatastore> store, size_t cache_size);
+
+    ~CachedDatastore() override = default;
+
+    /** @copydoc IpfsDatastore::contains() */
+    outcome::result<bool> contains(const CID &key) const override;
+
+    /** @copydoc IpfsDatastore::set() */
+    outcome::result<void> set(const CID &key, Value value) override;
+
+    /** @copydoc IpfsDatastore::get() */
+    outcome::result<Value> get(const CID &key) const override;
+
+    /** @copydoc IpfsDatastore::remove() */
+    outcome::result<void> remove(const CID &key) override;
+
+    /// Get cache counters
+    Cache::Stats cacheStats() const;
+
+   protected:
+    std::shared_ptr<const void> getDecoded(
+        const CID &key, const std::type_index &type) const override;
+
+    bool putDecoded(const CID &key,
+                    DecodedObject object,
+                    size_t size) const override;
+
+   private:
+    std::shared_ptr<IpfsDatastore> store_;
+    mutable Cache cache_;
+  };
+
+}  // namespace fc::storage::ipfs
+
+#endif  // CPP_FILECOIN_IPFS_IMPL_CACHED_DATASTORE_HPP
@@ -0,0 +1,107 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/ipld_resolver.hpp"
+
+#include <charconv>
+
+#include "primitives/address/address_codec.hpp"
+#include "storage/amt/amt.hpp"
+
+namespace fc::storage::ipfs {
+  using codec::cbor::CborResolveError;
+
+  IpldResolver::IpldResolver(std::shared_ptr<IpfsDatastore> ipld,
+                             size_t cache_size,
+                             Schema schema)
+      : ipld_{std::move(ipld)},
+        links_{cache_size},
+        schema_{std::move(schema)} {}
+
+  outcome::result<common::Buffer> IpldResolver::resolve(
+      const CID &root, const Path &path) const {
+    // start from longest memoized prefix
+    auto key = std::make_pair(root, path);
+    auto cid = root;
+    size_t consumed = 0;
+    for (auto i = path.size(); i > 0; --i) {
+      if (auto cached = links_.get(key)) {
+        cid = std::move(*cached);
+        consumed = i;
+        break;
+      }
+      key.second.pop_back();
+    }
+    if (consumed == path.size() && consumed != 0) {
+      OUTCOME_TRY(link, codec::cbor::encode(cid));
+      return common::Buffer{std::move(link)};
+    }
+    Path rest{path.begin() + consumed, path.end()};
+    while (true) {
+      common::Buffer node;
+      boost::optional<Collection> collection;
+      if (schema_ && !rest.empty()) {
+        collection = schema_({path.begin(), path.begin() + consumed});
+      }
+      if (collection) {
+        OUTCOME_TRY(value, lookup(*collection, cid, rest.front()));
+        node = std::move(value);
+        rest.erase(rest.begin());
+      } else {
+        OUTCOME_TRY(block, ipld_->get(cid));
+        node = std::move(block);
+      }
+      OUTCOME_TRY(resolved, codec::cbor::resolve(node, rest));
+      auto &[object, remaining] = resolved;
+      consumed = path.size() - remaining.size();
+      if (remaining.empty()) {
+        if (codec::cbor::CborDecodeStream::borrow(object).isCid()) {
+          OUTCOME_TRY(link, codec::cbor::decode<CID>(object));
+          links_.put({root, Path{path.begin(), path.begin() + consumed}},
+                     std::move(link),
+                     1);
+        }
+        return common::Buffer{std::move(object)};
+      }
+      OUTCOME_TRY(link, codec::cbor::decode<CID>(object));
+      links_.put(
+          {root, Path{path.begin(), path.begin() + consumed}}, link, 1);
+      cid = std::move(link);
+      rest = std::move(remaining);
+    }
+  }
+
+  outcome::result<common::Buffer> IpldResolver::lookup(
+      const Collection &collection,
+      const CID &root,
+      const std::string &key) const {
+    if (collection.type == CollectionType::kHamt) {
+      if (collection.bit_width == 0
+          || collection.bit_width > hamt::kMaxBitWidth) {
+        return hamt::HamtError::INVALID_BIT_WIDTH;
+      }
+      hamt::Hamt hamt{ipld_, root, collection.bit_width};
+      if (collection.key_encoding == KeyEncoding::kAddress) {
+        OUTCOME_TRY(address, primitives::address::decodeFromString(key));
+        return hamt.get(primitives::address::encode(address));
+      }
+      return hamt.get(key);
+    }
+    uint64_t index;
+    auto end = key.data() + key.size();
+    auto parsed = std::from_chars(key.data(), end, index);
+    if (parsed.ec == std::errc::result_out_of_range) {
+      return CborResolveError::KEY_NOT_FOUND;
+    }
+    if (parsed.ec != std::errc{} || parsed.ptr != end) {
+      return CborResolveError::INT_KEY_EXPECTED;
+    }
+    return amt::Amt{ipld_, root}.get(index);
+  }
+
+  IpldResolver::LinkCache::Stats IpldResolver::cacheStats() const {
+    return links_.stats();
+  }
+}  // namespace fc::storage::ipfs
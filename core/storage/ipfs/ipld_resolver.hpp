@@ -0,0 +1,93 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CPP_FILECOIN_CORE_STORAGE_IPFS_IPLD_RESOLVER_HPP
+#define CPP_FILECOIN_CORE_STORAGE_IPFS_IPLD_RESOLVER_HPP
+
+#include <functional>
+
+#include <boost/optional.hpp>
+
+#include "storage/hamt/hamt.hpp"
+#include "storage/ipfs/datastore.hpp"
+
+namespace fc::storage::ipfs {
+  /**
+   * Resolves paths in CBOR objects following CID links across blocks.
+   * Blocks are immutable, so CIDs reached by path prefixes are memoized and
+   * reused by later queries sharing the prefix.
+   *
+   * Path segments are plain CBOR map keys and list indices, like in
+   * codec::cbor::resolve. Links to HAMT or AMT roots are interpreted only
+   * where schema marks them, then next segment is key in collection (e.g.
+   * address in actors HAMT of state root) or decimal AMT index. Schema also
+   * tells how HAMT key is encoded and bit width of HAMT.
+   */
+  class IpldResolver {
+   public:
+    using Path = codec::cbor::Path;
+    /// Memo of CID reached by path prefix from root
+    using LinkCache = common::LruCache<std::pair<CID, Path>, CID>;
+
+    /// Type of collection stored behind link
+    enum class CollectionType { kHamt, kAmt };
+    /// Encoding of HAMT key given by path segment
+    enum class KeyEncoding {
+      /// Key is segment itself
+      kString,
+      /// Segment is address string, key is address bytes
+      kAddress,
+    };
+    /// Collection stored behind link
+    struct Collection {
+      CollectionType type;
+      KeyEncoding key_encoding{KeyEncoding::kString};
+      /// Bit width of HAMT
+      size_t bit_width{hamt::kDefaultBitWidth};
+    };
+    /**
+     * Tells whether link reached by path prefix from root is collection
+     * root, none for plain CBOR block
+     */
+    using Schema =
+        std::function<boost::optional<Collection>(const Path &prefix)>;
+
+    /**
+     * @param ipld - datastore to load blocks from
+     * @param cache_size - max count of memoized path prefixes
+     * @param schema - marks collection links, none if there are no
+     * collections; it must not change, because memo relies on it
+     */
+    IpldResolver(std::shared_ptr<IpfsDatastore> ipld,
+                 size_t cache_size,
+                 Schema schema = {});
+
+    /**
+     * @brief Resolve path starting at root block. Links in the middle of path
+     * are followed, link at the end of path is returned as is.
+     * @param root - CID of block to start from
+     * @param path - path segments, CBOR map keys, list indices or keys in
+     * collections marked by schema
+     * @return CBOR encoded object at path
+     */
+    outcome::result<common::Buffer> resolve(const CID &root,
+                                            const Path &path) const;
+
+    /// Get memo cache counters
+    LinkCache::Stats cacheStats() const;
+
+   private:
+    /// Get CBOR encoded value by key in collection with given root
+    outcome::result<common::Buffer> lookup(const Collection &collection,
+                                           const CID &root,
+                                           const std::string &key) const;
+
+    std::shared_ptr<IpfsDatastore> ipld_;
+    mutable LinkCache links_;
+    Schema schema_;
+  };
+}  // namespace fc::storage::ipfs
+
+#endif  // CPP_FILECOIN_CORE_STORAGE_IPFS_IPLD_RESOLVER_HPP
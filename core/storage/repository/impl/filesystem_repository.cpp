@@ -10,11 +10,13 @@
 #include "boost/filesystem.hpp"
 #include "crypto/bls/impl/bls_provider_impl.hpp"
 #include "crypto/secp256k1/secp256k1_provider.hpp"
+#include "storage/ipfs/impl/cached_datastore.hpp"
 #include "storage/ipfs/impl/datastore_leveldb.hpp"
 #include "storage/keystore/impl/filesystem/filesystem_keystore.hpp"
 #include "storage/repository/repository_error.hpp"
 
 using fc::crypto::bls::BlsProviderImpl;
+using fc::storage::ipfs::CachedDatastore;
 using fc::storage::ipfs::LeveldbDatastore;
 using fc::storage::keystore::FileSystemKeyStore;
 using fc::storage::repository::FileSystemRepository;
@@ -86,8 +88,10 @@ fc::outcome::result<std::shared_ptr<Repository>> FileSystemRepository::create(
   // create datastore
   auto datastore_path =
       repo_path + fc::storage::filestore::DELIMITER + kDatastore;
-  OUTCOME_TRY(ipfs_datastore,
+  OUTCOME_TRY(leveldb_datastore,
               LeveldbDatastore::create(datastore_path, leveldb_options));
+  auto ipfs_datastore =
+      std::make_shared<CachedDatastore>(leveldb_datastore, kDecodedCacheSize);
 
   // create keystore
   auto keystore_path =
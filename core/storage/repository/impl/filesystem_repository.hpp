@@ -48,6 +48,11 @@ namespace fc::storage::repository {
     inline static const std::string kRepositoryLock = "repo.lock";
     inline static const std::string kVersionFilename = "version";
     inline static const Version kFileSystemRepositoryVersion = 1;
+    /**
+     * Limit of datastore decoded cache in encoded bytes of cached objects,
+     * decoded objects take several times more memory
+     */
+    inline static const size_t kDecodedCacheSize = 64 << 20;
 
     FileSystemRepository(std::shared_ptr<IpfsDatastore> ipld_store,
                          std::shared_ptr<KeyStore> keystore,
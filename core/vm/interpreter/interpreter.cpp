@@ -5,8 +5,10 @@
 
 #include "vm/interpreter/interpreter.hpp"
 
+#include "codec/cbor/cbor_tuple_view.hpp"
 #include "crypto/randomness/randomness_provider.hpp"
 #include "storage/amt/amt.hpp"
+#include "storage/amt/amt_builder.hpp"
 #include "vm/actor/builtin/cron/cron_actor.hpp"
 #include "vm/actor/builtin/miner/miner_actor.hpp"
 #include "vm/actor/impl/invoker_impl.hpp"
@@ -49,6 +51,7 @@ namespace fc::vm::interpreter {
   using runtime::RuntimeImpl;
   using state::StateTreeImpl;
   using storage::amt::Amt;
+  using storage::amt::AmtBuilder;
 
   bool hasDuplicateMiners(const std::vector<BlockHeader> &blocks) {
     std::set<Address> set;
@@ -63,9 +66,13 @@ namespace fc::vm::interpreter {
   outcome::result<Address> getMinerOwner(StateTreeImpl &state_tree,
                                          const Address &miner) {
     OUTCOME_TRY(actor, state_tree.get(miner));
+    OUTCOME_TRY(bytes, state_tree.getStore()->get(actor.head));
+    // decode only miner info, not sector tables and bitfields
     OUTCOME_TRY(state,
-                state_tree.getStore()->getCbor<MinerActorState>(actor.head));
-    return state.info.owner;
+                codec::cbor::CborTupleView<MinerActorState>::make(
+                    std::move(bytes.toVector())));
+    OUTCOME_TRY(info, state.get<&MinerActorState::info>());
+    return info.owner;
   }
 
   outcome::result<Result> interpret(const std::shared_ptr<IpfsDatastore> &ipld,
@@ -178,11 +185,11 @@ namespace fc::vm::interpreter {
 
     OUTCOME_TRY(new_state_root, state_tree->flush());
 
-    Amt receipts_amt{ipld};
-    for (auto i = 0u; i < receipts.size(); ++i) {
-      OUTCOME_TRY(receipts_amt.setCbor(i, receipts[i]));
+    AmtBuilder receipts_amt{ipld};
+    for (auto &receipt : receipts) {
+      OUTCOME_TRY(receipts_amt.appendCbor(receipt));
     }
-    OUTCOME_TRY(receipts_root, receipts_amt.flush());
+    OUTCOME_TRY(receipts_root, receipts_amt.build());
 
     return Result{
         new_state_root,
@@ -10,6 +10,7 @@
 namespace fc::vm::message {
 
   using codec::cbor::encode;
+  using codec::cbor::encodedSize;
   using common::getCidOf;
   using crypto::signature::typeCode;
 
@@ -28,8 +29,8 @@ namespace fc::vm::message {
   }
 
   outcome::result<uint64_t> size(const SignedMessage &sm) {
-    OUTCOME_TRY(encoded, encode<SignedMessage>(sm));
-    return encoded.size();
+    OUTCOME_TRY(size, encodedSize(sm));
+    return size;
   }
 
 };  // namespace fc::vm::message
@@ -34,10 +34,9 @@ namespace fc::vm::runtime {
     ++from_actor.nonce;
     OUTCOME_TRY(state_tree->set(message.from, from_actor));
 
-    OUTCOME_TRY(serialized_message, codec::cbor::encode(message));
-    BigInt gas_used =
-        kOnChainMessageBaseGasCost
-        + serialized_message.size() * kOnChainMessagePerByteGasCharge;
+    OUTCOME_TRY(message_size, codec::cbor::encodedSize(message));
+    BigInt gas_used = kOnChainMessageBaseGasCost
+                      + message_size * kOnChainMessagePerByteGasCharge;
 
     auto result = send(gas_used, message.from, message);
     if (!result) {
@@ -9,6 +9,15 @@
 #include "primitives/address/address_codec.hpp"
 #include "vm/actor/builtin/init/init_actor.hpp"
 
+OUTCOME_CPP_DEFINE_CATEGORY(fc::vm::state, StateTreeError, e) {
+  using E = fc::vm::state::StateTreeError;
+  switch (e) {
+    case E::NO_CHECKPOINT:
+      return "No checkpoint";
+  }
+  return "Unknown error";
+}
+
 namespace fc::vm::state {
   using actor::ActorSubstateCID;
   using codec::cbor::decode;
@@ -61,12 +70,35 @@ namespace fc::vm::state {
 
   outcome::result<CID> StateTreeImpl::flush() {
     OUTCOME_TRY(cid, hamt_.flush());
-    snapshot_ = hamt_;
+    snapshot_ = hamt_.snapshot();
+    checkpoints_.clear();
     return std::move(cid);
   }
 
   outcome::result<void> StateTreeImpl::revert() {
-    hamt_ = snapshot_;
+    hamt_ = snapshot_.snapshot();
+    checkpoints_.clear();
+    return outcome::success();
+  }
+
+  void StateTreeImpl::checkpoint() {
+    checkpoints_.push_back(hamt_.snapshot());
+  }
+
+  outcome::result<void> StateTreeImpl::revertCheckpoint() {
+    if (checkpoints_.empty()) {
+      return StateTreeError::NO_CHECKPOINT;
+    }
+    hamt_ = std::move(checkpoints_.back());
+    checkpoints_.pop_back();
+    return outcome::success();
+  }
+
+  outcome::result<void> StateTreeImpl::commitCheckpoint() {
+    if (checkpoints_.empty()) {
+      return StateTreeError::NO_CHECKPOINT;
+    }
+    checkpoints_.pop_back();
     return outcome::success();
   }
 
@@ -33,16 +33,24 @@ namespace fc::vm::state {
     /// Allocate id address and set actor state, does not write to storage
     outcome::result<Address> registerNewAddress(const Address &address,
                                                 const Actor &actor) override;
-    /// Write changes to storage
+    /// Write changes to storage, drops checkpoints
     outcome::result<CID> flush() override;
-    /// Revert changes to last flushed state
+    /// Revert changes to last flushed state, drops checkpoints
     outcome::result<void> revert() override;
+    /// Save current state on checkpoint stack, O(1) copy of hamt root
+    void checkpoint() override;
+    /// Restore state saved by last checkpoint and remove checkpoint
+    outcome::result<void> revertCheckpoint() override;
+    /// Remove last checkpoint keeping changes made after it
+    outcome::result<void> commitCheckpoint() override;
     /// Get store
     std::shared_ptr<IpfsDatastore> getStore() override;
 
    private:
     std::shared_ptr<IpfsDatastore> store_;
+    /// Hamt snapshots share nodes and copy modified paths, so they are cheap
     Hamt hamt_, snapshot_;
+    std::vector<Hamt> checkpoints_;
   };
 }  // namespace fc::vm::state
 
@@ -9,6 +9,12 @@
 #include "storage/hamt/hamt.hpp"
 #include "vm/actor/actor.hpp"
 
+namespace fc::vm::state {
+  enum class StateTreeError { NO_CHECKPOINT = 1 };
+}  // namespace fc::vm::state
+
+OUTCOME_HPP_DECLARE_ERROR(fc::vm::state, StateTreeError);
+
 namespace fc::vm::state {
 
   using actor::Actor;
@@ -40,6 +46,15 @@ namespace fc::vm::state {
     /// Revert changes to last flushed state
     virtual outcome::result<void> revert() = 0;
 
+    /// Save current state on checkpoint stack, does not write to storage
+    virtual void checkpoint() = 0;
+
+    /// Restore state saved by last checkpoint and remove checkpoint
+    virtual outcome::result<void> revertCheckpoint() = 0;
+
+    /// Remove last checkpoint keeping changes made after it
+    virtual outcome::result<void> commitCheckpoint() = 0;
+
     /// Get store
     virtual std::shared_ptr<IpfsDatastore> getStore() = 0;
   };
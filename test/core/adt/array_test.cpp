@@ -102,3 +102,25 @@ TEST_F(Fixture, UnderlyingAmt) {
         return fc::outcome::success();
       }));
 }
+
+/**
+ * @given Array with appended values
+ * @when elements are accessed by index and by range
+ * @then expected elements are returned
+ */
+TEST_F(Fixture, GetAndVisitRange) {
+  EXPECT_OUTCOME_TRUE_1(appendValues(array_));
+  EXPECT_OUTCOME_TRUE(array_root, array_.flush());
+  fc::adt::Array array{store_, array_root};
+  EXPECT_OUTCOME_EQ(array.get(1), values_[1]);
+  EXPECT_FALSE(array.get(3));
+
+  std::vector<uint64_t> indices;
+  EXPECT_OUTCOME_TRUE_1(
+      array.visit(1, 10, [&](uint64_t index, const Value &value) {
+        EXPECT_EQ(value, values_[index]);
+        indices.push_back(index);
+        return fc::outcome::success();
+      }));
+  EXPECT_EQ(indices, (std::vector<uint64_t>{1, 2}));
+}
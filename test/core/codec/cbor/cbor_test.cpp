@@ -4,6 +4,7 @@
  */
 
 #include "codec/cbor/cbor.hpp"
+#include "codec/cbor/cbor_tuple_view.hpp"
 #include "primitives/big_int.hpp"
 
 #include <gtest/gtest.h>
@@ -28,6 +29,21 @@ auto kCidRaw =
 auto kCidCbor =
     "D82A582300122031C3D57080D8463A3C63B2923DF5A1D40AD7A73EAE5A14AF584213E5F504AC33"_unhex;
 
+namespace fc::codec::cbor {
+  struct TupleInner {
+    int a;
+    std::string b;
+  };
+  CBOR_TUPLE(TupleInner, a, b)
+
+  struct TupleOuter {
+    TupleInner inner;
+    std::vector<TupleInner> list;
+    bool c;
+  };
+  CBOR_TUPLE(TupleOuter, inner, list, c)
+}  // namespace fc::codec::cbor
+
 template <typename T>
 void expectDecodeOne(const std::vector<uint8_t> &encoded, const T &expected) {
   EXPECT_OUTCOME_EQ(decode<T>(encoded), expected);
@@ -111,6 +127,11 @@ TEST(CborEncoder, Integral) {
   EXPECT_OUTCOME_EQ(encode(23), "17"_unhex);
   EXPECT_OUTCOME_EQ(encode(24), "1818"_unhex);
   EXPECT_OUTCOME_EQ(encode(-1), "20"_unhex);
+  EXPECT_OUTCOME_EQ(encode(-25), "3818"_unhex);
+  EXPECT_OUTCOME_EQ(encode(256), "190100"_unhex);
+  EXPECT_OUTCOME_EQ(encode(65536), "1A00010000"_unhex);
+  EXPECT_OUTCOME_EQ(encode(1ull << 32), "1B0000000100000000"_unhex);
+  EXPECT_OUTCOME_EQ(encode(INT64_MIN), "3B7FFFFFFFFFFFFFFF"_unhex);
   EXPECT_OUTCOME_EQ(encode(false), "F4"_unhex);
   EXPECT_OUTCOME_EQ(encode(true), "F5"_unhex);
 }
@@ -209,6 +230,84 @@ TEST(CborEncoder, Map) {
   map["c"] << 3;
   s << map;
   EXPECT_EQ(s.data(), "A361620261630362616101"_unhex);
+
+  // map of values is written in place in same key order
+  std::map<std::string, int> values{{"aa", 1}, {"b", 2}, {"c", 3}};
+  EXPECT_OUTCOME_EQ(encode(values), "A361620261630362616101"_unhex);
+  CborEncodeStream s2;
+  s2 << values << 4;
+  EXPECT_EQ(s2.data(), "A36162026163036261610104"_unhex);
+}
+
+/**
+ * @given Nested tuples
+ * @when Encode them directly, in list and as map value
+ * @then Encoded same as lists of fields, each tuple counts as one element
+ */
+TEST(CborEncoder, Tuple) {
+  using fc::codec::cbor::TupleInner;
+  using fc::codec::cbor::TupleOuter;
+  TupleOuter outer{{1, "x"}, {{2, "y"}, {3, "z"}}, true};
+  EXPECT_OUTCOME_EQ(encode(outer), "838201617882820261798203617AF5"_unhex);
+  EXPECT_OUTCOME_TRUE(decoded, decode<TupleOuter>(encode(outer).value()));
+  EXPECT_EQ(decoded.list[1].b, "z");
+
+  CborEncodeStream s;
+  auto l = s.list();
+  l << outer << 4;
+  auto map = s.map();
+  map["k"] << TupleInner{5, "w"};
+  s << l << map;
+  EXPECT_EQ(s.data(),
+            "82838201617882820261798203617AF504A1616B82056177"_unhex);
+}
+
+/**
+ * @given Values of different types
+ * @when Compute encoded size
+ * @then Size equals to size of encoding
+ */
+TEST(CborEncoder, EncodedSize) {
+  using fc::codec::cbor::encodedSize;
+  using fc::codec::cbor::TupleInner;
+  using fc::codec::cbor::TupleOuter;
+  auto expectSize = [](const auto &value) {
+    EXPECT_OUTCOME_TRUE(encoded, encode(value));
+    EXPECT_OUTCOME_EQ(encodedSize(value), encoded.size());
+  };
+  for (auto num : {0ll, 23ll, 24ll, 255ll, 256ll, -25ll, 1ll << 40}) {
+    expectSize(num);
+  }
+  expectSize(true);
+  expectSize(std::string(300, 'a'));
+  expectSize(std::vector<uint8_t>(70000));
+  expectSize(kCidRaw);
+  expectSize(boost::optional<int>{});
+  expectSize(std::vector<std::string>(30, "x"));
+  expectSize(std::map<std::string, int>{{"a", 1}, {"bb", 1000}});
+  expectSize(std::map<std::string, std::vector<int>>{{"a", {1, 2, 3}}});
+  expectSize(TupleOuter{{1, "x"}, std::vector<TupleInner>(25), false});
+  EXPECT_OUTCOME_ERROR(CborEncodeError::INVALID_CID, encodedSize(CID()));
+}
+
+/**
+ * @given Map with single element list substream value
+ * @when Compute encoded size
+ * @then Size includes list header and equals to size of encoding
+ */
+TEST(CborEncoder, EncodedSizeMapListValue) {
+  using fc::codec::cbor::CborSizeStream;
+  CborEncodeStream encoder;
+  auto encoder_map = encoder.map();
+  encoder_map["k"] = encoder.list();
+  encoder_map["k"] << 1;
+  encoder << encoder_map;
+  CborSizeStream sizer;
+  auto sizer_map = sizer.map();
+  sizer_map["k"] = sizer.list();
+  sizer_map["k"] << 1;
+  sizer << sizer_map;
+  EXPECT_EQ(sizer.size(), encoder.data().size());
 }
 
 /**
@@ -317,6 +416,25 @@ TEST(CborDecoder, String) {
   EXPECT_EQ(s, "foo");
 }
 
+/**
+ * @given Bytes and string CBOR in list
+ * @when Decode them as views from borrowed buffer
+ * @then Views point into buffer
+ */
+TEST(CborDecoder, BorrowViews) {
+  auto bytes = "8242010263666F6F"_unhex;
+  auto l = CborDecodeStream::borrow(bytes).list();
+  gsl::span<const uint8_t> b;
+  std::string_view str;
+  l >> b >> str;
+  EXPECT_EQ(b, gsl::make_span("0102"_unhex));
+  EXPECT_EQ(b.data(), bytes.data() + 2);
+  EXPECT_EQ(str, "foo");
+  EXPECT_EQ(reinterpret_cast<const uint8_t *>(str.data()), bytes.data() + 5);
+  EXPECT_OUTCOME_RAISE(CborDecodeError::WRONG_TYPE,
+                       CborDecodeStream("01"_unhex) >> b);
+}
+
 /**
  * @given Map CBOR
  * @when Decode map container
@@ -329,6 +447,46 @@ TEST(CborDecoder, Map) {
   m.at("b").list() >> b;
 }
 
+/**
+ * @given Map CBOR
+ * @when Read map entries sequentially
+ * @then Keys and values are read in order, values may be skipped
+ */
+TEST(CborDecoder, MapEntries) {
+  auto s = CborDecodeStream("A26161026162810101"_unhex);
+  EXPECT_EQ(s.mapLength(), 2);
+  auto m = s.mapEntries();
+  std::string_view key;
+  int a, c;
+  m >> key;
+  EXPECT_EQ(key, "a");
+  m >> a;
+  EXPECT_EQ(a, 2);
+  m >> key;
+  EXPECT_EQ(key, "b");
+  m.next();
+  s >> c;
+  EXPECT_EQ(c, 1);
+  EXPECT_OUTCOME_RAISE(CborDecodeError::WRONG_TYPE,
+                       CborDecodeStream("01"_unhex).mapEntries());
+}
+
+/**
+ * @given Indefinite length map CBOR {"a": 1}
+ * @when Read it as map, map entries or map length
+ * @then INVALID_CBOR error, only definite lengths are allowed in DAG-CBOR
+ */
+TEST(CborDecoder, IndefiniteMap) {
+  auto bytes = "BF616101FF"_unhex;
+  EXPECT_TRUE(CborDecodeStream(bytes).isMap());
+  EXPECT_OUTCOME_RAISE(CborDecodeError::INVALID_CBOR,
+                       CborDecodeStream(bytes).map());
+  EXPECT_OUTCOME_RAISE(CborDecodeError::INVALID_CBOR,
+                       CborDecodeStream(bytes).mapEntries());
+  EXPECT_OUTCOME_RAISE(CborDecodeError::INVALID_CBOR,
+                       CborDecodeStream(bytes).mapLength());
+}
+
 /**
  * @given Invalid CBOR
  * @when Init decoder
@@ -511,3 +669,44 @@ TEST(CborResolve, Errors) {
   EXPECT_OUTCOME_ERROR(CborDecodeError::INVALID_CBOR,
                        resolve("8281"_unhex, {"1"}));
 }
+
+/**
+ * @given Indefinite length map CBOR {"a": 1}
+ * @when Resolve key of it
+ * @then INVALID_CBOR error, only definite lengths are allowed in DAG-CBOR
+ */
+TEST(CborResolve, IndefiniteMap) {
+  EXPECT_OUTCOME_ERROR(CborDecodeError::INVALID_CBOR,
+                       resolve("BF616101FF"_unhex, {"a"}));
+}
+
+/**
+ * @given Encoded tuple
+ * @when Make lazy view of it
+ * @then Fields are decoded individually, malformed tuples are rejected
+ */
+TEST(CborTupleView, Fields) {
+  using fc::codec::cbor::CborTupleView;
+  using fc::codec::cbor::TupleInner;
+  using fc::codec::cbor::TupleOuter;
+  using View = CborTupleView<TupleOuter>;
+  static_assert(View::kSize == 3);
+  static_assert(View::index<&TupleOuter::c>() == 2);
+
+  TupleOuter outer{{1, "x"}, {{2, "y"}, {3, "z"}}, true};
+  EXPECT_OUTCOME_TRUE(view, View::make(encode(outer).value()));
+  EXPECT_OUTCOME_EQ(view.get<&TupleOuter::c>(), true);
+  EXPECT_EQ(view.raw<&TupleOuter::inner>(), gsl::make_span("82016178"_unhex));
+  EXPECT_OUTCOME_TRUE(list, view.get<&TupleOuter::list>());
+  EXPECT_EQ(list[1].b, "z");
+
+  EXPECT_OUTCOME_TRUE(inner,
+                      CborTupleView<TupleInner>::make(
+                          {view.raw<&TupleOuter::inner>().begin(),
+                           view.raw<&TupleOuter::inner>().end()}));
+  EXPECT_OUTCOME_EQ(inner.get<&TupleInner::b>(), "x");
+
+  EXPECT_OUTCOME_ERROR(CborDecodeError::WRONG_SIZE,
+                       View::make("820102"_unhex));
+  EXPECT_OUTCOME_ERROR(CborDecodeError::WRONG_TYPE, View::make("01"_unhex));
+}
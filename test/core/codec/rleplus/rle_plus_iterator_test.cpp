@@ -0,0 +1,70 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "codec/rle/rle_plus_iterator.hpp"
+
+#include <gtest/gtest.h>
+
+#include "codec/rle/rle_plus.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::codec::rle::contains;
+using fc::codec::rle::count;
+using fc::codec::rle::encodeRuns;
+using fc::codec::rle::RLEPlusDecodeError;
+using fc::codec::rle::RlePlusRuns;
+using fc::codec::rle::RlePlusValues;
+using Runs = std::vector<fc::codec::rle::Run>;
+
+/**
+ * @given RLE+ encoded runs
+ * @when Iterate runs and values
+ * @then Runs and values are decoded lazily in order
+ */
+TEST(RlePlusIteratorTest, Iterate) {
+  Runs runs{{0, 2}, {5, 1}, {100, 3}};
+  auto bytes = encodeRuns(runs);
+  RlePlusRuns range_runs{bytes};
+  EXPECT_EQ(Runs(range_runs.begin(), range_runs.end()), runs);
+  RlePlusValues values{bytes};
+  EXPECT_EQ(std::vector<uint64_t>(values.begin(), values.end()),
+            (std::vector<uint64_t>{0, 1, 5, 100, 101, 102}));
+  auto it = values.begin();
+  std::advance(it, 2);
+  EXPECT_EQ(*it, 5);
+
+  auto empty = encodeRuns({});
+  RlePlusValues empty_values{empty};
+  EXPECT_EQ(empty_values.begin(), empty_values.end());
+}
+
+/**
+ * @given RLE+ encoded runs
+ * @when Count and check bits without decoding
+ * @then Results match runs
+ */
+TEST(RlePlusIteratorTest, CountContains) {
+  auto bytes = encodeRuns(Runs{{3, 10000000}, {20000000, 1}});
+  EXPECT_OUTCOME_EQ(count(bytes), 10000001);
+  EXPECT_OUTCOME_EQ(contains(bytes, 2), false);
+  EXPECT_OUTCOME_EQ(contains(bytes, 3), true);
+  EXPECT_OUTCOME_EQ(contains(bytes, 10000002), true);
+  EXPECT_OUTCOME_EQ(contains(bytes, 10000003), false);
+  EXPECT_OUTCOME_EQ(contains(bytes, 20000000), true);
+  EXPECT_OUTCOME_EQ(contains(bytes, 20000001), false);
+}
+
+/**
+ * @given Invalid RLE+ bytes
+ * @when Count and iterate them
+ * @then Error is returned or thrown
+ */
+TEST(RlePlusIteratorTest, Errors) {
+  std::vector<uint8_t> bytes{0xFF};
+  EXPECT_OUTCOME_ERROR(RLEPlusDecodeError::VersionMismatch, count(bytes));
+  EXPECT_OUTCOME_ERROR(RLEPlusDecodeError::VersionMismatch,
+                       contains(bytes, 0));
+  EXPECT_THROW(RlePlusValues{bytes}.begin(), std::system_error);
+}
@@ -0,0 +1,129 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "codec/rle/rle_plus_reader.hpp"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include "codec/rle/rle_plus.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::codec::rle::decode;
+using fc::codec::rle::decodeRuns;
+using fc::codec::rle::encode;
+using fc::codec::rle::RLEPlusDecodeError;
+using fc::codec::rle::RLEPlusDecodingStream;
+using fc::codec::rle::Run;
+using Runs = std::vector<Run>;
+
+/// Set of 100000 values in runs of 1 to 7 values with gaps of 1 to 7
+std::set<uint64_t> largeMixedSet() {
+  std::set<uint64_t> values;
+  for (uint64_t value = 0; values.size() < 100000; value += value % 7 + 1) {
+    values.insert(value);
+  }
+  return values;
+}
+
+/**
+ * @given Set with single, small and long blocks
+ * @when Decode runs
+ * @then Runs of set bits are decoded
+ */
+TEST(RlePlusReaderTest, Runs) {
+  std::set<uint64_t> values{0, 2, 4, 5, 6, 11, 12, 13, 14, 15, 16, 17,
+                            18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 1000};
+  EXPECT_OUTCOME_EQ(decodeRuns(encode(values)),
+                    (Runs{{0, 1}, {2, 1}, {4, 3}, {11, 17}, {1000, 1}}));
+  EXPECT_OUTCOME_EQ(decodeRuns(encode(std::set<uint64_t>{})), Runs{});
+  EXPECT_OUTCOME_EQ(decodeRuns(encode(std::set<uint64_t>{1ull << 40})),
+                    (Runs{{1ull << 40, 1}}));
+}
+
+/**
+ * @given Invalid RLE+ data
+ * @when Decode runs
+ * @then Error is returned
+ */
+TEST(RlePlusReaderTest, Errors) {
+  EXPECT_OUTCOME_ERROR(RLEPlusDecodeError::VersionMismatch, decodeRuns({}));
+  EXPECT_OUTCOME_ERROR(RLEPlusDecodeError::VersionMismatch,
+                       decodeRuns(std::vector<uint8_t>{0x01}));
+  // zero length small block
+  EXPECT_OUTCOME_ERROR(RLEPlusDecodeError::DataIndexFailure,
+                       decodeRuns(std::vector<uint8_t>{0x14, 0x00}));
+  // truncated long block
+  EXPECT_OUTCOME_ERROR(RLEPlusDecodeError::DataIndexFailure,
+                       decodeRuns(std::vector<uint8_t>{0x04, 0xFF}));
+  // long block length over 64 bits
+  std::vector<uint8_t> overflow(12, 0xFF);
+  overflow[0] = 0x04;
+  EXPECT_OUTCOME_ERROR(RLEPlusDecodeError::UnpackOverflow,
+                       decodeRuns(overflow));
+}
+
+/**
+ * @given Large set of mixed runs
+ * @when Decode it with bitwise decoding stream, into set and into runs
+ * @then All decodings give same values
+ */
+TEST(RlePlusReaderTest, LargeMixedSet) {
+  auto values = largeMixedSet();
+  auto encoded = encode(values);
+  std::set<uint64_t> streamed;
+  RLEPlusDecodingStream{encoded} >> streamed;
+  EXPECT_EQ(streamed, values);
+  EXPECT_OUTCOME_EQ(decode<uint64_t>(encoded), values);
+  EXPECT_OUTCOME_TRUE(runs, decodeRuns(encoded));
+  std::set<uint64_t> expanded;
+  for (auto &run : runs) {
+    for (auto i = run.start; i < run.end(); ++i) {
+      expanded.insert(expanded.end(), i);
+    }
+  }
+  EXPECT_EQ(expanded, values);
+}
+
+/**
+ * @given Large set of mixed runs
+ * @when Decode it repeatedly with bitwise decoding stream, into set and into
+ * runs
+ * @then Mean time of each decoding in microseconds is recorded as test
+ * property (run with --gtest_also_run_disabled_tests)
+ */
+TEST(RlePlusReaderTest, DISABLED_DecodeBenchmark) {
+  using Clock = std::chrono::steady_clock;
+  auto values = largeMixedSet();
+  auto encoded = encode(values);
+  constexpr auto kRepeat = 20;
+  auto time = [](auto f) {
+    auto start = Clock::now();
+    for (auto i = 0; i < kRepeat; ++i) {
+      f();
+    }
+    auto total = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - start);
+    return static_cast<int>(total.count() / kRepeat);
+  };
+  auto stream_us = time([&] {
+    std::set<uint64_t> decoded;
+    RLEPlusDecodingStream{encoded} >> decoded;
+    EXPECT_EQ(decoded.size(), values.size());
+  });
+  auto set_us = time([&] {
+    EXPECT_OUTCOME_TRUE(decoded, decode<uint64_t>(encoded));
+    EXPECT_EQ(decoded.size(), values.size());
+  });
+  auto runs_us = time([&] {
+    EXPECT_OUTCOME_TRUE(runs, decodeRuns(encoded));
+    EXPECT_FALSE(runs.empty());
+  });
+  RecordProperty("bytes", static_cast<int>(encoded.size()));
+  RecordProperty("stream_us", stream_us);
+  RecordProperty("set_us", set_us);
+  RecordProperty("runs_us", runs_us);
+}
@@ -0,0 +1,57 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "codec/rle/rle_plus_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include "codec/rle/rle_plus.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::codec::rle::decodeRuns;
+using fc::codec::rle::encodeRuns;
+using fc::codec::rle::RLEPlusEncodingStream;
+using fc::codec::rle::RlePlusWriter;
+using Runs = std::vector<fc::codec::rle::Run>;
+
+/**
+ * @given Sets with single, small and long blocks
+ * @when Encode them with writer and with bitwise encoding stream
+ * @then Encoded bytes are same
+ */
+TEST(RlePlusWriterTest, SameAsStream) {
+  std::vector<std::set<uint64_t>> sets{{}, {0}, {1}, {2, 7}};
+  std::set<uint64_t> mixed;
+  for (uint64_t value = 0; value < 100000; value += value % 300 + 1) {
+    mixed.insert(value);
+  }
+  sets.push_back(mixed);
+  sets.push_back({1ull << 62, (1ull << 62) + 1});
+  for (auto &set : sets) {
+    RLEPlusEncodingStream stream;
+    stream << set;
+    RlePlusWriter writer;
+    for (auto value : set) {
+      writer.append(value);
+    }
+    EXPECT_EQ(writer.finish(), stream.data());
+  }
+}
+
+/**
+ * @given Runs, some of them adjacent
+ * @when Encode runs
+ * @then Adjacent runs are merged, decoding yields merged runs
+ */
+TEST(RlePlusWriterTest, Runs) {
+  EXPECT_OUTCOME_EQ(decodeRuns(encodeRuns(Runs{{0, 3}, {3, 2}, {10, 100}})),
+                    (Runs{{0, 5}, {10, 100}}));
+  RlePlusWriter writer;
+  writer.append(fc::codec::rle::Run{5, 20});
+  writer.append(fc::codec::rle::Run{1000000, 1});
+  auto bytes = writer.finish();
+  EXPECT_OUTCOME_EQ(decodeRuns(bytes), (Runs{{5, 20}, {1000000, 1}}));
+  EXPECT_EQ(writer.finish(), std::vector<uint8_t>{0x00});
+}
@@ -0,0 +1,40 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/executor.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using fc::common::Executor;
+using fc::common::runTasks;
+
+/**
+ * @given tasks and executor running them on detached threads
+ * @when run tasks and one of them throws
+ * @then all tasks are complete @and exception is rethrown to caller
+ */
+TEST(ExecutorTest, RunTasksRethrows) {
+  Executor executor = [](std::function<void()> task) {
+    std::thread{std::move(task)}.detach();
+  };
+  std::vector<std::atomic<bool>> done(8);
+  std::vector<std::function<void()>> tasks;
+  for (size_t i = 0; i < done.size(); ++i) {
+    tasks.emplace_back([&, i] {
+      done[i] = true;
+      if (i == 3) {
+        throw std::runtime_error{"task"};
+      }
+    });
+  }
+  EXPECT_THROW(runTasks(executor, std::move(tasks)), std::runtime_error);
+  for (auto &task_done : done) {
+    EXPECT_TRUE(task_done);
+  }
+}
@@ -0,0 +1,140 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/flush_writes.hpp"
+
+#include <gtest/gtest.h>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+#include "testutil/outcome.hpp"
+
+using fc::common::Buffer;
+
+struct Node {
+  boost::optional<int> cid;
+  std::vector<Node> children;
+};
+
+using Writes = fc::common::FlushWrites<int, Node>;
+
+/// Encode node after its children, key is count of nodes encoded before
+fc::outcome::result<void> flushNode(Node &node, Writes &writes) {
+  for (auto &child : node.children) {
+    OUTCOME_TRY(flushNode(child, writes));
+  }
+  if (node.cid == -1) {
+    return std::make_error_code(std::errc::io_error);
+  }
+  node.cid = static_cast<int>(writes.size());
+  writes.add(*node.cid, Buffer{}, node);
+  return fc::outcome::success();
+}
+
+/**
+ * @given encoded nodes
+ * @when second write fails
+ * @then first node stays flushed @and others are unflushed
+ */
+TEST(FlushWritesTest, WriteFailureUnflushes) {
+  std::vector<Node> nodes(3);
+  Writes writes;
+  for (auto &node : nodes) {
+    EXPECT_OUTCOME_TRUE_1(flushNode(node, writes));
+  }
+  std::vector<int> written;
+  auto error = std::make_error_code(std::errc::io_error);
+  EXPECT_OUTCOME_ERROR(error, writes.write([&](int key, Buffer) {
+    if (key == 1) {
+      return fc::outcome::result<void>{error};
+    }
+    written.push_back(key);
+    return fc::outcome::result<void>{fc::outcome::success()};
+  }));
+  EXPECT_EQ(written, std::vector<int>{0});
+  EXPECT_EQ(*nodes[0].cid, 0);
+  EXPECT_FALSE(nodes[1].cid);
+  EXPECT_FALSE(nodes[2].cid);
+}
+
+/**
+ * @given subtrees and executor
+ * @when encode them concurrently
+ * @then writes are in order of children with children before parents
+ */
+TEST(FlushWritesTest, FlushConcurrently) {
+  boost::asio::thread_pool pool{4};
+  fc::common::Executor executor = [&pool](auto task) {
+    boost::asio::post(pool, std::move(task));
+  };
+  std::vector<Node> subtrees(8, Node{{}, std::vector<Node>(3)});
+  std::vector<Node *> children;
+  for (auto &subtree : subtrees) {
+    children.push_back(&subtree);
+  }
+  Writes writes;
+  EXPECT_OUTCOME_TRUE_1(
+      writes.flushConcurrently(executor, children, flushNode));
+  EXPECT_EQ(writes.size(), 32);
+
+  std::vector<int> written;
+  EXPECT_OUTCOME_TRUE_1(writes.write([&](int key, Buffer) {
+    written.push_back(key);
+    return fc::outcome::result<void>{fc::outcome::success()};
+  }));
+  // keys are counted per subtree
+  std::vector<int> expected;
+  for (size_t i = 0; i < subtrees.size(); ++i) {
+    expected.insert(expected.end(), {0, 1, 2, 3});
+  }
+  EXPECT_EQ(written, expected);
+  EXPECT_EQ(*subtrees[7].cid, 3);
+}
+
+/**
+ * @given subtrees one of which fails to encode
+ * @when encode them concurrently
+ * @then error is returned @and writes of all subtrees can be unflushed
+ */
+TEST(FlushWritesTest, FlushConcurrentlyFailure) {
+  boost::asio::thread_pool pool{4};
+  fc::common::Executor executor = [&pool](auto task) {
+    boost::asio::post(pool, std::move(task));
+  };
+  std::vector<Node> subtrees(4, Node{{}, std::vector<Node>(1)});
+  subtrees[2].children[0].cid = -1;
+  std::vector<Node *> children;
+  for (auto &subtree : subtrees) {
+    children.push_back(&subtree);
+  }
+  Writes writes;
+  EXPECT_OUTCOME_ERROR(
+      std::make_error_code(std::errc::io_error),
+      writes.flushConcurrently(executor, children, flushNode));
+  EXPECT_EQ(writes.size(), 6);
+  EXPECT_EQ(*subtrees[3].cid, 1);
+
+  writes.unflush();
+  for (auto &subtree : subtrees) {
+    EXPECT_FALSE(subtree.cid);
+  }
+}
+
+/**
+ * @given subtrees without executor
+ * @when encode them concurrently
+ * @then nothing is encoded, so caller encodes them serially
+ */
+TEST(FlushWritesTest, NoExecutor) {
+  std::vector<Node> subtrees(4);
+  std::vector<Node *> children;
+  for (auto &subtree : subtrees) {
+    children.push_back(&subtree);
+  }
+  Writes writes;
+  EXPECT_OUTCOME_TRUE_1(writes.flushConcurrently({}, children, flushNode));
+  EXPECT_EQ(writes.size(), 0);
+  EXPECT_FALSE(subtrees[0].cid);
+}
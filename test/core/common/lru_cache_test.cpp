@@ -0,0 +1,90 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "common/lru_cache.hpp"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+using fc::common::LruCache;
+
+/**
+ * @given empty cache
+ * @when put value and get it
+ * @then value is returned @and hits and misses are counted
+ */
+TEST(LruCacheTest, GetPut) {
+  LruCache<int, std::string> cache{10};
+  EXPECT_FALSE(cache.get(1));
+  cache.put(1, "a", 1);
+  EXPECT_EQ(*cache.get(1), std::string{"a"});
+  cache.put(1, "b", 2);
+  EXPECT_EQ(*cache.get(1), std::string{"b"});
+
+  auto stats = cache.stats();
+  EXPECT_EQ(stats.hits, 2);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.entries, 1);
+  EXPECT_EQ(stats.size, 2);
+}
+
+/**
+ * @given full cache
+ * @when put new value
+ * @then least recently used values are evicted until new value fits
+ */
+TEST(LruCacheTest, EvictLeastRecentlyUsed) {
+  LruCache<int, int> cache{3};
+  cache.put(1, 1, 1);
+  cache.put(2, 2, 1);
+  cache.put(3, 3, 1);
+  EXPECT_EQ(*cache.get(1), 1);
+
+  cache.put(4, 4, 2);
+  EXPECT_EQ(*cache.get(1), 1);
+  EXPECT_FALSE(cache.get(2));
+  EXPECT_FALSE(cache.get(3));
+  EXPECT_EQ(*cache.get(4), 4);
+
+  auto stats = cache.stats();
+  EXPECT_EQ(stats.evictions, 2);
+  EXPECT_EQ(stats.entries, 2);
+  EXPECT_EQ(stats.size, 3);
+}
+
+/**
+ * @given cache
+ * @when put value larger than cache
+ * @then value is not cached
+ */
+TEST(LruCacheTest, TooLarge) {
+  LruCache<int, int> cache{3};
+  EXPECT_TRUE(cache.put(1, 1, 1));
+  EXPECT_FALSE(cache.put(2, 2, 4));
+  EXPECT_EQ(*cache.get(1), 1);
+  EXPECT_FALSE(cache.get(2));
+  EXPECT_EQ(cache.stats().evictions, 0);
+}
+
+/**
+ * @given cache with values
+ * @when erase value
+ * @then only that value is removed and its size is released
+ */
+TEST(LruCacheTest, Erase) {
+  LruCache<int, int> cache{3};
+  cache.put(1, 1, 1);
+  cache.put(2, 2, 2);
+  cache.erase(2);
+  cache.erase(3);
+  EXPECT_EQ(*cache.get(1), 1);
+  EXPECT_FALSE(cache.get(2));
+
+  auto stats = cache.stats();
+  EXPECT_EQ(stats.evictions, 0);
+  EXPECT_EQ(stats.entries, 1);
+  EXPECT_EQ(stats.size, 1);
+}
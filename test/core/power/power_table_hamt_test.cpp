@@ -19,12 +19,14 @@ using fc::storage::hamt::Hamt;
 using fc::storage::ipfs::InMemoryDatastore;
 using fc::storage::ipfs::IpfsDatastore;
 
+/// Copy would share max power aggregate with original
+static_assert(!std::is_copy_constructible_v<PowerTableHamt>);
+
 class PowerTableHamtTest : public ::testing::Test {
  public:
   std::shared_ptr<IpfsDatastore> datastore =
       std::make_shared<InMemoryDatastore>();
-  Hamt hamt{datastore};
-  PowerTableHamt power_table{hamt};
+  PowerTableHamt power_table{Hamt{datastore}};
   Address addr{Address::makeFromId(3232104785)};
   Address addr1{Address::makeFromId(111)};
   Address addr2{Address::makeFromId(2222)};
@@ -129,6 +131,27 @@ TEST_F(PowerTableHamtTest, GetMaxPowerSuccess) {
   EXPECT_OUTCOME_EQ(power_table.getMaxPower(), max);
 }
 
+/**
+ * @given table with 3 miners
+ * @when remove and update miners after size and max power were queried
+ * @then size and max power reflect changes
+ */
+TEST_F(PowerTableHamtTest, MaintainedSizeMaxPower) {
+  EXPECT_OUTCOME_TRUE_1(power_table.setMinerPower(addr, 10));
+  EXPECT_OUTCOME_TRUE_1(power_table.setMinerPower(addr1, 30));
+  EXPECT_OUTCOME_TRUE_1(power_table.setMinerPower(addr2, 20));
+  EXPECT_OUTCOME_EQ(power_table.getSize(), 3);
+  EXPECT_OUTCOME_EQ(power_table.getMaxPower(), 30);
+
+  EXPECT_OUTCOME_TRUE_1(power_table.removeMiner(addr1));
+  EXPECT_OUTCOME_EQ(power_table.getSize(), 2);
+  EXPECT_OUTCOME_EQ(power_table.getMaxPower(), 20);
+
+  EXPECT_OUTCOME_TRUE_1(power_table.setMinerPower(addr, 40));
+  EXPECT_OUTCOME_EQ(power_table.getSize(), 2);
+  EXPECT_OUTCOME_EQ(power_table.getMaxPower(), 40);
+}
+
 /**
  * @given empty table
  * @when get miners
@@ -6,14 +6,100 @@
 #include "primitives/rle_bitset/rle_bitset.hpp"
 
 #include <gtest/gtest.h>
+
 #include "testutil/cbor.hpp"
 
+using fc::primitives::RleBitset;
+using Runs = RleBitset::Runs;
+
 /**
  * @given rle bitset and its serialized representation from go
  * @when encode @and decode the rle bitset
  * @then decoded version matches the original @and encoded matches the go ones
  */
 TEST(RleBitsetTest, RleBitsetCbor) {
-  using fc::primitives::RleBitset;
   expectEncodeAndReencode(RleBitset{2, 7}, "43504a01"_unhex);
 }
+
+/**
+ * @given Values inserted in any order
+ * @when Insert and erase values
+ * @then Adjacent values are merged into runs, erase splits runs
+ */
+TEST(RleBitsetTest, InsertErase) {
+  RleBitset set{5, 1, 3, 2, 7};
+  EXPECT_EQ(set.runs(), (Runs{{1, 3}, {5, 1}, {7, 1}}));
+  EXPECT_TRUE(set.insert(6));
+  EXPECT_FALSE(set.insert(6));
+  EXPECT_EQ(set.runs(), (Runs{{1, 3}, {5, 3}}));
+  EXPECT_EQ(set.size(), 6);
+  EXPECT_TRUE(set.contains(3));
+  EXPECT_FALSE(set.contains(4));
+  EXPECT_FALSE(set.contains(0));
+  EXPECT_FALSE(set.contains(8));
+  EXPECT_TRUE(set.erase(6));
+  EXPECT_FALSE(set.erase(6));
+  EXPECT_TRUE(set.erase(1));
+  EXPECT_EQ(set.runs(), (Runs{{2, 2}, {5, 1}, {7, 1}}));
+  EXPECT_EQ(std::vector<uint64_t>(set.begin(), set.end()),
+            (std::vector<uint64_t>{2, 3, 5, 7}));
+}
+
+/**
+ * @given Random sets
+ * @when Union, intersect and subtract them
+ * @then Result matches std::set algorithms
+ */
+TEST(RleBitsetTest, SetOperations) {
+  auto random = [](unsigned seed) {
+    std::set<uint64_t> values;
+    std::srand(seed);
+    for (auto i = 0; i < 300; ++i) {
+      values.insert(std::rand() % 500);
+    }
+    return values;
+  };
+  auto expect = [](const RleBitset &set, const std::set<uint64_t> &values) {
+    EXPECT_EQ(set, RleBitset(values.begin(), values.end()));
+    EXPECT_EQ(set.size(), values.size());
+  };
+  for (unsigned seed = 1; seed < 10; ++seed) {
+    auto a = random(seed);
+    auto b = random(seed + 100);
+    RleBitset set_a(a.begin(), a.end());
+    RleBitset set_b(b.begin(), b.end());
+    std::set<uint64_t> expected;
+    std::set_union(a.begin(),
+                   a.end(),
+                   b.begin(),
+                   b.end(),
+                   std::inserter(expected, expected.end()));
+    expect(set_a | set_b, expected);
+    expected.clear();
+    std::set_intersection(a.begin(),
+                          a.end(),
+                          b.begin(),
+                          b.end(),
+                          std::inserter(expected, expected.end()));
+    expect(set_a & set_b, expected);
+    expected.clear();
+    std::set_difference(a.begin(),
+                        a.end(),
+                        b.begin(),
+                        b.end(),
+                        std::inserter(expected, expected.end()));
+    expect(set_a - set_b, expected);
+  }
+}
+
+/**
+ * @given Set of 10M consecutive values
+ * @when Encode and decode it
+ * @then It is stored and encoded as single run
+ */
+TEST(RleBitsetTest, LargeRun) {
+  auto set = RleBitset::fromRuns({{1, 10000000}});
+  EXPECT_OUTCOME_TRUE(encoded, fc::codec::cbor::encode(set));
+  EXPECT_LT(encoded.size(), 8);
+  EXPECT_OUTCOME_EQ(fc::codec::cbor::decode<RleBitset>(encoded), set);
+}
@@ -0,0 +1,145 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "primitives/roaring_bitmap/roaring_bitmap.hpp"
+
+#include <gtest/gtest.h>
+
+#include "testutil/cbor.hpp"
+
+using fc::primitives::RleBitset;
+using fc::primitives::RoaringBitmap;
+
+/// Random set with sparse and dense regions across several containers
+RleBitset randomSet(unsigned seed) {
+  RleBitset set;
+  std::srand(seed);
+  for (auto i = 0; i < 3000; ++i) {
+    set.insert(std::rand() % 200000);
+  }
+  for (auto i = 0; i < 10; ++i) {
+    uint64_t start = std::rand() % 300000;
+    set |= RleBitset::fromRuns({{start, std::rand() % 20000 + 1u}});
+  }
+  return set;
+}
+
+/**
+ * @given Values inserted into bitmap
+ * @when Insert and erase values
+ * @then Containers switch between array and bitmap by cardinality
+ */
+TEST(RoaringBitmapTest, InsertErase) {
+  RoaringBitmap bitmap{1, 70000, 3};
+  EXPECT_EQ(bitmap.size(), 3);
+  EXPECT_TRUE(bitmap.contains(70000));
+  EXPECT_FALSE(bitmap.contains(2));
+  EXPECT_FALSE(bitmap.insert(3));
+  EXPECT_TRUE(bitmap.erase(70000));
+  EXPECT_FALSE(bitmap.erase(70000));
+  EXPECT_EQ(bitmap.containers().size(), 1);
+
+  RoaringBitmap dense;
+  for (uint64_t value = 0; value <= RoaringBitmap::kArrayMax; ++value) {
+    dense.insert(value * 2);
+  }
+  EXPECT_TRUE(dense.containers()[0].isBitmap());
+  EXPECT_TRUE(dense.contains(8192));
+  EXPECT_FALSE(dense.contains(8191));
+  EXPECT_TRUE(dense.erase(0));
+  EXPECT_FALSE(dense.containers()[0].isBitmap());
+  EXPECT_EQ(dense.size(), RoaringBitmap::kArrayMax);
+}
+
+/**
+ * @given Random sets
+ * @when Convert them to bitmaps and combine
+ * @then Results match operations on RleBitset
+ */
+TEST(RoaringBitmapTest, SetOperations) {
+  for (unsigned seed = 1; seed < 6; ++seed) {
+    auto a = randomSet(seed);
+    auto b = randomSet(seed + 100);
+    auto bitmap_a = RoaringBitmap::fromRleBitset(a);
+    auto bitmap_b = RoaringBitmap::fromRleBitset(b);
+    EXPECT_EQ(bitmap_a.toRleBitset(), a);
+    EXPECT_EQ(bitmap_a.size(), a.size());
+    EXPECT_EQ((bitmap_a | bitmap_b).toRleBitset(), a | b);
+    EXPECT_EQ((bitmap_a & bitmap_b).toRleBitset(), a & b);
+    EXPECT_EQ((bitmap_a - bitmap_b).toRleBitset(), a - b);
+    EXPECT_EQ(bitmap_a | bitmap_b, RoaringBitmap::fromRleBitset(a | b));
+  }
+}
+
+/**
+ * @given Array container and bitmap container with same key
+ * @when Combine them in both orders
+ * @then Results have expected values and container kinds
+ */
+TEST(RoaringBitmapTest, ArrayBitmapOperations) {
+  RoaringBitmap array{1, 2, 64, 65535};
+  RoaringBitmap dense;
+  for (uint64_t value = 0; value <= RoaringBitmap::kArrayMax; ++value) {
+    dense.insert(value * 2);
+  }
+  ASSERT_FALSE(array.containers()[0].isBitmap());
+  ASSERT_TRUE(dense.containers()[0].isBitmap());
+
+  auto both = dense;
+  both.insert(1);
+  both.insert(65535);
+  EXPECT_EQ(array | dense, both);
+  EXPECT_EQ(dense | array, both);
+  EXPECT_TRUE((array | dense).containers()[0].isBitmap());
+
+  RoaringBitmap common{2, 64};
+  EXPECT_EQ(array & dense, common);
+  EXPECT_EQ(dense & array, common);
+
+  EXPECT_EQ(array - dense, (RoaringBitmap{1, 65535}));
+  auto rest = dense - array;
+  EXPECT_EQ(rest.size(), RoaringBitmap::kArrayMax - 1);
+  EXPECT_FALSE(rest.containers()[0].isBitmap());
+  EXPECT_FALSE(rest.contains(64));
+  EXPECT_TRUE(rest.contains(66));
+}
+
+/**
+ * @given Bitmap
+ * @when Encode and decode it
+ * @then Encoded as RLE+ same as RleBitset
+ */
+TEST(RoaringBitmapTest, Cbor) {
+  expectEncodeAndReencode(RoaringBitmap{2, 7}, "43504a01"_unhex);
+  auto set = randomSet(1);
+  EXPECT_OUTCOME_EQ(
+      fc::codec::cbor::encode(RoaringBitmap::fromRleBitset(set)),
+      fc::codec::cbor::encode(set).value());
+}
+
+/**
+ * @given RLE+ of few bytes with run of 2^40 values, and sets around limit
+ * @when Decode them as bitmap
+ * @then Sets over limit are rejected without allocating containers
+ */
+TEST(RoaringBitmapTest, CborMaxSize) {
+  using fc::codec::rle::RLEPlusDecodeError;
+  auto huge = RleBitset::fromRuns({{0, uint64_t{1} << 40}});
+  EXPECT_OUTCOME_TRUE(encoded, fc::codec::cbor::encode(huge));
+  EXPECT_LT(encoded.size(), 16);
+  EXPECT_OUTCOME_ERROR(RLEPlusDecodeError::MaxSizeExceed,
+                       fc::codec::cbor::decode<RoaringBitmap>(encoded));
+
+  auto max = RoaringBitmap::kMaxDecodedSize;
+  auto limit = RleBitset::fromRuns({{5, max - 1}, {max + 10, 1}});
+  EXPECT_OUTCOME_TRUE(decoded,
+                      fc::codec::cbor::decode<RoaringBitmap>(
+                          fc::codec::cbor::encode(limit).value()));
+  EXPECT_EQ(decoded.size(), max);
+  EXPECT_OUTCOME_ERROR(
+      RLEPlusDecodeError::MaxSizeExceed,
+      RoaringBitmap::fromRleBitset(
+          RleBitset::fromRuns({{0, max}, {max + 1, 1}}), max));
+}
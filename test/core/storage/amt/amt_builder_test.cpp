@@ -0,0 +1,50 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/amt/amt_builder.hpp"
+
+#include <gtest/gtest.h>
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::storage::amt::Amt;
+using fc::storage::amt::AmtBuilder;
+using fc::storage::ipfs::InMemoryDatastore;
+
+class AmtBuilderTest : public ::testing::TestWithParam<uint64_t> {
+ public:
+  std::shared_ptr<InMemoryDatastore> store{
+      std::make_shared<InMemoryDatastore>()};
+};
+
+/**
+ * @given count of values filling levels fully and partially
+ * @when append them with builder and set them to amt
+ * @then roots are equal and builder writes each node once
+ */
+TEST_P(AmtBuilderTest, SameRootAsAmt) {
+  auto count = GetParam();
+  AmtBuilder builder{store};
+  Amt amt{store};
+  for (auto i = 0llu; i < count; ++i) {
+    EXPECT_OUTCOME_TRUE_1(builder.appendCbor(i * 3));
+    EXPECT_OUTCOME_TRUE_1(amt.setCbor(i, i * 3));
+  }
+  EXPECT_EQ(builder.count(), count);
+  EXPECT_OUTCOME_TRUE(root, amt.flush());
+  EXPECT_OUTCOME_EQ(builder.build(), root);
+  EXPECT_EQ(builder.writtenNodes(), amt.flushedNodes());
+  EXPECT_EQ(builder.count(), 0);
+
+  amt = {store, root};
+  EXPECT_OUTCOME_EQ(amt.count(), count);
+  if (count != 0) {
+    EXPECT_OUTCOME_EQ(amt.getCbor<uint64_t>(count - 1), (count - 1) * 3);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(AmtBuilderTestCases,
+                        AmtBuilderTest,
+                        ::testing::Values(0, 1, 7, 8, 9, 64, 65, 100, 513, 600));
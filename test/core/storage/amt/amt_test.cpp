@@ -6,6 +6,7 @@
 #include "storage/amt/amt.hpp"
 
 #include <gtest/gtest.h>
+#include "storage/ipfs/impl/cached_datastore.hpp"
 #include "storage/ipfs/impl/in_memory_datastore.hpp"
 #include "testutil/cbor.hpp"
 
@@ -16,6 +17,7 @@ using fc::storage::amt::AmtError;
 using fc::storage::amt::Node;
 using fc::storage::amt::Root;
 using fc::storage::amt::Value;
+using fc::storage::ipfs::CachedDatastore;
 using fc::storage::ipfs::InMemoryDatastore;
 
 class AmtTest : public ::testing::Test {
@@ -72,6 +74,33 @@ TEST_F(AmtTest, SetRemoveRootLeaf) {
   EXPECT_TRUE(getRoot().node.has_bits);
 }
 
+/**
+ * @given amt with value by key, in root leaf and in nested leaf
+ * @when set other value by same key
+ * @then value is replaced @and count is unchanged @and root is same as if
+ * only new value was set, like in go-amt-ipld
+ */
+TEST_F(AmtTest, SetOverwrites) {
+  for (auto key : {3llu, 100llu}) {
+    Amt amt1{store};
+    EXPECT_OUTCOME_TRUE_1(amt1.set(key, "06"_unhex));
+    EXPECT_OUTCOME_TRUE_1(amt1.set(key, "07"_unhex));
+    EXPECT_OUTCOME_EQ(amt1.get(key), Value{"07"_unhex});
+    EXPECT_OUTCOME_EQ(amt1.count(), 1);
+    EXPECT_OUTCOME_TRUE(cid, amt1.flush());
+
+    Amt amt2{store, cid};
+    EXPECT_OUTCOME_EQ(amt2.get(key), Value{"07"_unhex});
+    EXPECT_OUTCOME_TRUE_1(amt2.set(key, "08"_unhex));
+    EXPECT_OUTCOME_EQ(amt2.get(key), Value{"08"_unhex});
+    EXPECT_OUTCOME_EQ(amt2.count(), 1);
+
+    Amt amt3{store};
+    EXPECT_OUTCOME_TRUE_1(amt3.set(key, "07"_unhex));
+    EXPECT_OUTCOME_EQ(amt3.flush(), cid);
+  }
+}
+
 TEST_F(AmtTest, SetRemoveCollapseZero) {
   auto key = 64;
 
@@ -85,6 +114,28 @@ TEST_F(AmtTest, SetRemoveCollapseZero) {
   EXPECT_TRUE(which<Node::Values>(getRoot().node.items));
 }
 
+/**
+ * @given amt root with several links, or single link not at zero index
+ * @when remove value so root height may shrink
+ * @then root collapses only into single zero link @and other values stay
+ */
+TEST_F(AmtTest, RemoveCollapseOnlySingleZeroLink) {
+  EXPECT_OUTCOME_TRUE_1(amt.set(1, "01"_unhex));
+  EXPECT_OUTCOME_TRUE_1(amt.set(9, "09"_unhex));
+  EXPECT_OUTCOME_TRUE_1(amt.set(64, "40"_unhex));
+  EXPECT_EQ(getRoot().height, 2);
+
+  EXPECT_OUTCOME_TRUE_1(amt.remove(64));
+  EXPECT_EQ(getRoot().height, 1);
+  EXPECT_OUTCOME_EQ(amt.get(1), Value{"01"_unhex});
+  EXPECT_OUTCOME_EQ(amt.get(9), Value{"09"_unhex});
+
+  EXPECT_OUTCOME_TRUE_1(amt.remove(1));
+  EXPECT_EQ(getRoot().height, 1);
+  EXPECT_OUTCOME_EQ(amt.get(9), Value{"09"_unhex});
+  EXPECT_OUTCOME_EQ(amt.count(), 1);
+}
+
 TEST_F(AmtTest, Flush) {
   auto key = 9llu;
   auto value = Value{"07"_unhex};
@@ -96,6 +147,72 @@ TEST_F(AmtTest, Flush) {
   EXPECT_OUTCOME_EQ(amt.get(key), value);
 }
 
+/**
+ * @given flushed amt loaded from root
+ * @when flush without changes and after changing one value
+ * @then only root and nodes on path to changed value are written
+ */
+TEST_F(AmtTest, FlushOnlyModified) {
+  EXPECT_OUTCOME_TRUE_1(amt.set(1, "01"_unhex));
+  EXPECT_OUTCOME_TRUE_1(amt.set(9, "02"_unhex));
+  EXPECT_OUTCOME_TRUE_1(amt.set(64, "03"_unhex));
+  EXPECT_OUTCOME_TRUE(cid, amt.flush());
+  // root, two inner nodes and three leaves
+  EXPECT_EQ(amt.flushedNodes(), 6);
+
+  amt = {store, cid};
+  EXPECT_OUTCOME_EQ(amt.get(1), Value{"01"_unhex});
+  EXPECT_OUTCOME_EQ(amt.get(9), Value{"02"_unhex});
+  EXPECT_OUTCOME_EQ(amt.get(64), Value{"03"_unhex});
+  EXPECT_OUTCOME_EQ(amt.flush(), cid);
+  EXPECT_EQ(amt.flushedNodes(), 0);
+
+  EXPECT_OUTCOME_TRUE_1(amt.set(9, "04"_unhex));
+  EXPECT_OUTCOME_TRUE(cid2, amt.flush());
+  EXPECT_NE(cid2, cid);
+  // root, inner node and leaf containing key
+  EXPECT_EQ(amt.flushedNodes(), 3);
+  EXPECT_OUTCOME_EQ(amt.get(1), Value{"01"_unhex});
+  EXPECT_OUTCOME_EQ(amt.get(9), Value{"04"_unhex});
+
+  Amt amt2{store};
+  EXPECT_OUTCOME_TRUE_1(amt2.set(1, "01"_unhex));
+  EXPECT_OUTCOME_TRUE_1(amt2.set(9, "04"_unhex));
+  EXPECT_OUTCOME_TRUE_1(amt2.set(64, "03"_unhex));
+  EXPECT_OUTCOME_EQ(amt2.flush(), cid2);
+}
+
+/**
+ * @given amt of several levels loaded twice through caching datastore
+ * @when writer overwrites and removes values in leaf decoded by reader
+ * @then leaf and its parents are copied before modification @and reader and
+ * new loads of old root still see old values
+ */
+TEST_F(AmtTest, CachedNodesCopiedOnWrite) {
+  auto cached_store = std::make_shared<CachedDatastore>(store, 1 << 20);
+  for (auto key = 0llu; key < 200; key += 3) {
+    EXPECT_OUTCOME_TRUE_1(amt.setCbor(key, key));
+  }
+  EXPECT_OUTCOME_TRUE(cid, amt.flush());
+
+  Amt reader{cached_store, cid};
+  Amt writer{cached_store, cid};
+  EXPECT_OUTCOME_EQ(reader.getCbor<uint64_t>(99), 99);
+  EXPECT_OUTCOME_TRUE_1(writer.setCbor(99, 1));
+  EXPECT_OUTCOME_TRUE_1(writer.remove(102));
+  EXPECT_OUTCOME_TRUE_1(
+      reader.visit([](auto, auto &) { return fc::outcome::success(); }));
+  EXPECT_OUTCOME_EQ(reader.getCbor<uint64_t>(99), 99);
+  EXPECT_OUTCOME_EQ(reader.getCbor<uint64_t>(102), 102);
+  EXPECT_OUTCOME_EQ(writer.getCbor<uint64_t>(99), 1);
+  EXPECT_OUTCOME_ERROR(AmtError::NOT_FOUND, writer.get(102));
+
+  EXPECT_OUTCOME_EQ(Amt(cached_store, cid).getCbor<uint64_t>(99), 99);
+  EXPECT_OUTCOME_TRUE(cid2, writer.flush());
+  EXPECT_OUTCOME_EQ(Amt(cached_store, cid2).getCbor<uint64_t>(99), 1);
+  EXPECT_OUTCOME_EQ(Amt(cached_store, cid2).count(), 66);
+}
+
 class AmtVisitTest : public AmtTest {
  public:
   AmtVisitTest() : AmtTest{} {
@@ -143,3 +260,44 @@ TEST_F(AmtVisitTest, VisitError) {
                          return AmtError::INDEX_TOO_BIG;
                        }));
 }
+
+/**
+ * @given flushed amt of height 3 with left subtree missing from storage
+ * @when visit ranges
+ * @then exactly keys in range are visited and left subtree is loaded only
+ * for ranges covering it
+ */
+TEST_F(AmtTest, VisitRange) {
+  for (auto key = 0llu; key < 1000; ++key) {
+    EXPECT_OUTCOME_TRUE_1(amt.setCbor(key, key));
+  }
+  EXPECT_OUTCOME_TRUE(cid, amt.flush());
+  EXPECT_OUTCOME_TRUE(root, store->getCbor<Root>(cid));
+  EXPECT_EQ(root.height, 3);
+  auto &links = boost::get<Node::Links>(root.node.items);
+  EXPECT_OUTCOME_TRUE_1(store->remove(boost::get<fc::CID>(links.at(0))));
+
+  auto expectRange = [&](uint64_t from, uint64_t to, uint64_t last) {
+    std::vector<uint64_t> keys;
+    EXPECT_OUTCOME_TRUE_1(
+        amt.visit(from, to, [&](uint64_t key, const Value &value) {
+          EXPECT_OUTCOME_EQ(fc::codec::cbor::decode<uint64_t>(value), key);
+          keys.push_back(key);
+          return fc::outcome::success();
+        }));
+    std::vector<uint64_t> expected;
+    for (auto key = from; key < last; ++key) {
+      expected.push_back(key);
+    }
+    EXPECT_EQ(keys, expected);
+  };
+  amt = {store, cid};
+  expectRange(512, 520, 520);
+  expectRange(600, 601, 601);
+  expectRange(990, 5000, 1000);
+  expectRange(700, 700, 700);
+  EXPECT_OUTCOME_EQ(amt.getCbor<uint64_t>(777), 777);
+  EXPECT_FALSE(amt.visit(500, 520, [](auto, auto &) {
+    return fc::outcome::success();
+  }));
+}
@@ -0,0 +1,99 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/hamt/aggregated_hamt.hpp"
+
+#include <gtest/gtest.h>
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::codec::cbor::encode;
+using fc::storage::hamt::AggregatedHamt;
+using fc::storage::hamt::Hamt;
+using fc::storage::hamt::HamtError;
+using fc::storage::hamt::MaxAggregate;
+using fc::storage::hamt::SumAggregate;
+using fc::storage::hamt::Value;
+using fc::storage::ipfs::InMemoryDatastore;
+
+class AggregatedHamtTest : public ::testing::Test {
+ public:
+  std::shared_ptr<InMemoryDatastore> store{
+      std::make_shared<InMemoryDatastore>()};
+  std::shared_ptr<MaxAggregate<int>> max{
+      std::make_shared<MaxAggregate<int>>()};
+  std::shared_ptr<SumAggregate<int>> sum{
+      std::make_shared<SumAggregate<int>>()};
+  AggregatedHamt<int> table{Hamt{store}, {max, sum}};
+};
+
+/**
+ * @given hamt with values
+ * @when load aggregated hamt over it
+ * @then count and aggregates are computed from values
+ */
+TEST_F(AggregatedHamtTest, Load) {
+  Hamt hamt{store};
+  EXPECT_OUTCOME_TRUE_1(hamt.setCbor("a", 3));
+  EXPECT_OUTCOME_TRUE_1(hamt.setCbor("b", 7));
+  EXPECT_OUTCOME_TRUE_1(hamt.setCbor("c", 5));
+  EXPECT_OUTCOME_TRUE(root, hamt.flush());
+
+  table.reset(Hamt{store, root});
+  EXPECT_OUTCOME_EQ(table.size(), 3);
+  EXPECT_EQ(*max->value(), 7);
+  EXPECT_EQ(sum->value(), 15);
+}
+
+/**
+ * @given loaded aggregated hamt
+ * @when set, replace and remove values
+ * @then count and aggregates are updated
+ */
+TEST_F(AggregatedHamtTest, Update) {
+  EXPECT_OUTCOME_EQ(table.size(), 0);
+  EXPECT_FALSE(max->value());
+
+  EXPECT_OUTCOME_TRUE_1(table.set("a", 3));
+  EXPECT_OUTCOME_TRUE_1(table.set("b", 7));
+  EXPECT_OUTCOME_EQ(table.size(), 2);
+  EXPECT_EQ(*max->value(), 7);
+  EXPECT_EQ(sum->value(), 10);
+
+  EXPECT_OUTCOME_TRUE_1(table.set("b", 1));
+  EXPECT_OUTCOME_EQ(table.size(), 2);
+  EXPECT_EQ(*max->value(), 3);
+  EXPECT_EQ(sum->value(), 4);
+
+  EXPECT_OUTCOME_TRUE_1(table.remove("a"));
+  EXPECT_OUTCOME_ERROR(HamtError::NOT_FOUND, table.remove("a"));
+  EXPECT_OUTCOME_EQ(table.size(), 1);
+  EXPECT_EQ(*max->value(), 1);
+  EXPECT_EQ(sum->value(), 1);
+  EXPECT_OUTCOME_EQ(table.get("b"), 1);
+}
+
+/// Copy would share aggregates with original
+static_assert(!std::is_copy_constructible_v<AggregatedHamt<int>>);
+static_assert(!std::is_copy_assignable_v<AggregatedHamt<int>>);
+
+/**
+ * @given loaded aggregated hamt with value
+ * @when value is replaced
+ * @then replaced value is found by same lookup @and aggregates are updated
+ */
+TEST_F(AggregatedHamtTest, ReplaceOneLookup) {
+  EXPECT_OUTCOME_TRUE_1(table.load());
+  EXPECT_OUTCOME_TRUE_1(table.set("a", 9));
+  EXPECT_OUTCOME_TRUE_1(table.set("a", 2));
+  EXPECT_OUTCOME_EQ(table.size(), 1);
+  EXPECT_EQ(*max->value(), 2);
+  EXPECT_EQ(sum->value(), 2);
+
+  EXPECT_OUTCOME_TRUE(old, table.hamt().exchange("a", encode(4).value()));
+  EXPECT_EQ(*old, Value{encode(2).value()});
+  EXPECT_OUTCOME_TRUE(none, table.hamt().exchange("b", encode(4).value()));
+  EXPECT_FALSE(none);
+}
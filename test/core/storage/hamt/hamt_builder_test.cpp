@@ -0,0 +1,78 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/hamt/hamt_builder.hpp"
+
+#include <gtest/gtest.h>
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::storage::hamt::Hamt;
+using fc::storage::hamt::HamtBuilder;
+using fc::storage::ipfs::InMemoryDatastore;
+
+class HamtBuilderTest : public ::testing::Test {
+ public:
+  std::shared_ptr<InMemoryDatastore> store{
+      std::make_shared<InMemoryDatastore>()};
+  HamtBuilder builder{store};
+  Hamt hamt{store};
+};
+
+/**
+ * @given no pairs
+ * @when build
+ * @then root is same as root of empty hamt
+ */
+TEST_F(HamtBuilderTest, Empty) {
+  EXPECT_OUTCOME_TRUE(root, hamt.flush());
+  EXPECT_OUTCOME_EQ(builder.build(), root);
+  EXPECT_EQ(builder.writtenNodes(), 1);
+}
+
+/**
+ * @given many unsorted pairs with duplicate keys
+ * @when build
+ * @then root is same as after setting pairs one by one and each node is
+ * written once
+ */
+TEST_F(HamtBuilderTest, SameAsSet) {
+  for (auto i = 0; i < 3000; ++i) {
+    auto key = "k" + std::to_string(i % 2000);
+    EXPECT_OUTCOME_TRUE_1(hamt.setCbor(key, i));
+    EXPECT_OUTCOME_TRUE_1(builder.addCbor(key, i));
+  }
+  EXPECT_OUTCOME_TRUE(root, hamt.flush());
+  EXPECT_OUTCOME_EQ(builder.build(), root);
+  EXPECT_EQ(builder.writtenNodes(), hamt.flushedNodes());
+  EXPECT_OUTCOME_EQ(Hamt(store, root).getCbor<int>("k1"), 2001);
+}
+
+/**
+ * @given builder with bit width 5
+ * @when build
+ * @then root is same as root of hamt with same bit width
+ */
+TEST_F(HamtBuilderTest, BitWidth5) {
+  builder = HamtBuilder{store, 5};
+  hamt = {store, 5};
+  for (auto i = 0; i < 500; ++i) {
+    auto key = std::to_string(i);
+    EXPECT_OUTCOME_TRUE_1(hamt.setCbor(key, i));
+    EXPECT_OUTCOME_TRUE_1(builder.addCbor(key, i));
+  }
+  EXPECT_OUTCOME_TRUE(root, hamt.flush());
+  EXPECT_OUTCOME_EQ(builder.build(), root);
+}
+
+/**
+ * @given bit width greater than max
+ * @when construct builder
+ * @then INVALID_BIT_WIDTH is raised
+ */
+TEST_F(HamtBuilderTest, InvalidBitWidth) {
+  EXPECT_THROW(HamtBuilder(store, fc::storage::hamt::kMaxBitWidth + 1),
+               std::system_error);
+}
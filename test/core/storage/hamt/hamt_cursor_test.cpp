@@ -0,0 +1,129 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/hamt/hamt_cursor.hpp"
+
+#include <gtest/gtest.h>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::storage::hamt::Hamt;
+using fc::storage::hamt::HamtCursor;
+using fc::storage::hamt::Value;
+using fc::storage::ipfs::InMemoryDatastore;
+
+class HamtCursorTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    for (auto i = 0; i < 1000; ++i) {
+      EXPECT_OUTCOME_TRUE_1(hamt.setCbor(std::to_string(i), i));
+    }
+    EXPECT_OUTCOME_TRUE(cid, hamt.flush());
+    root = cid;
+    EXPECT_OUTCOME_TRUE_1(hamt.visit([this](auto &key, auto &value) {
+      expected.emplace_back(key, value);
+      return fc::outcome::success();
+    }));
+  }
+
+  /// Read all pairs left in cursor
+  auto readAll(HamtCursor &cursor) {
+    std::vector<std::pair<std::string, Value>> pairs;
+    while (cursor.next().value()) {
+      pairs.emplace_back(cursor.key(), cursor.value());
+    }
+    return pairs;
+  }
+
+  std::shared_ptr<InMemoryDatastore> store{
+      std::make_shared<InMemoryDatastore>()};
+  Hamt hamt{store};
+  fc::CID root;
+  std::vector<std::pair<std::string, Value>> expected;
+};
+
+/**
+ * @given flushed hamt
+ * @when iterate it with and without prefetch
+ * @then pairs are same as visited
+ */
+TEST_F(HamtCursorTest, All) {
+  Hamt hamt1{store, root};
+  HamtCursor cursor1{hamt1};
+  EXPECT_EQ(readAll(cursor1), expected);
+
+  Hamt hamt2{store, root};
+  HamtCursor cursor2{hamt2, 4};
+  EXPECT_EQ(readAll(cursor2), expected);
+}
+
+/**
+ * @given flushed hamt with executor
+ * @when iterate it with prefetch
+ * @then siblings are decoded concurrently @and pairs are same as visited
+ */
+TEST_F(HamtCursorTest, PrefetchExecutor) {
+  boost::asio::thread_pool pool{4};
+  Hamt hamt1{store, root};
+  hamt1.setExecutor(
+      [&pool](auto task) { boost::asio::post(pool, std::move(task)); });
+  HamtCursor cursor{hamt1, 16};
+  EXPECT_EQ(readAll(cursor), expected);
+}
+
+/**
+ * @given cursor stopped in the middle
+ * @when new cursor seeks after last key seen
+ * @then it continues with next pair
+ */
+TEST_F(HamtCursorTest, Resume) {
+  Hamt hamt1{store, root};
+  HamtCursor cursor1{hamt1};
+  for (auto i = 0; i < 500; ++i) {
+    EXPECT_OUTCOME_EQ(cursor1.next(), true);
+  }
+  auto position = cursor1.key();
+
+  Hamt hamt2{store, root};
+  HamtCursor cursor2{hamt2};
+  EXPECT_OUTCOME_TRUE_1(cursor2.seekAfter(position));
+  auto rest = readAll(cursor2);
+  EXPECT_EQ(rest.size(), 500);
+  EXPECT_TRUE(std::equal(rest.begin(), rest.end(), expected.begin() + 500));
+}
+
+/**
+ * @given flushed hamt
+ * @when seek after each key
+ * @then next pair is the one following it
+ */
+TEST_F(HamtCursorTest, SeekEach) {
+  Hamt hamt1{store, root};
+  HamtCursor cursor{hamt1};
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_OUTCOME_TRUE_1(cursor.seekAfter(expected[i].first));
+    if (i + 1 < expected.size()) {
+      EXPECT_OUTCOME_EQ(cursor.next(), true);
+      EXPECT_EQ(cursor.key(), expected[i + 1].first);
+    } else {
+      EXPECT_OUTCOME_EQ(cursor.next(), false);
+    }
+  }
+}
+
+/**
+ * @given empty hamt
+ * @when iterate it
+ * @then there are no pairs
+ */
+TEST_F(HamtCursorTest, Empty) {
+  Hamt empty{store};
+  HamtCursor cursor{empty};
+  EXPECT_OUTCOME_EQ(cursor.next(), false);
+  EXPECT_OUTCOME_TRUE_1(cursor.seekAfter("a"));
+  EXPECT_OUTCOME_EQ(cursor.next(), false);
+}
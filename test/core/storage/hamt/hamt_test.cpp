@@ -6,8 +6,11 @@
 #include "storage/hamt/hamt.hpp"
 
 #include <gtest/gtest.h>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include "codec/cbor/cbor.hpp"
 #include "common/which.hpp"
+#include "storage/ipfs/impl/cached_datastore.hpp"
 #include "storage/ipfs/impl/in_memory_datastore.hpp"
 #include "testutil/cbor.hpp"
 
@@ -16,6 +19,7 @@ using fc::common::which;
 using fc::storage::hamt::Hamt;
 using fc::storage::hamt::HamtError;
 using fc::storage::hamt::Node;
+using fc::storage::ipfs::CachedDatastore;
 
 class HamtTest : public ::testing::Test {
  public:
@@ -58,6 +62,30 @@ TEST_F(HamtTest, NodeCbor) {
   EXPECT_OUTCOME_ERROR(HamtError::EXPECTED_CID, encode(n));
 }
 
+/**
+ * @given node with items in different bitmap words
+ * @when encode and decode it
+ * @then items keep their indices @and mismatch of bitfield and items fails
+ */
+TEST_F(HamtTest, NodeCborSparse) {
+  using fc::codec::cbor::CborDecodeError;
+  Node n;
+  for (auto i : {255, 0, 64, 63, 200}) {
+    n.items[i] = "010000020000"_cid;
+  }
+  EXPECT_OUTCOME_TRUE(bytes, encode(n));
+  EXPECT_OUTCOME_TRUE(decoded, fc::codec::cbor::decode<Node>(bytes));
+  std::vector<size_t> indices;
+  for (auto &item : decoded.items) {
+    indices.push_back(item.first);
+  }
+  EXPECT_EQ(indices, (std::vector<size_t>{0, 63, 64, 200, 255}));
+  EXPECT_OUTCOME_EQ(encode(decoded), bytes);
+
+  EXPECT_OUTCOME_ERROR(CborDecodeError::WRONG_SIZE,
+                       fc::codec::cbor::decode<Node>("82410180"_unhex));
+}
+
 /** Set-remove single element */
 TEST_F(HamtTest, SetRemoveOne) {
   EXPECT_OUTCOME_ERROR(HamtError::NOT_FOUND, hamt_.get("aai"));
@@ -176,6 +204,25 @@ TEST_F(HamtTest, CollapseSingleLeafShard) {
   EXPECT_TRUE(minItemIs<Node::Leaf>(*root_));
 }
 
+/**
+ * @given bit width which node bitmap can't index
+ * @when construct hamt
+ * @then INVALID_BIT_WIDTH is raised
+ */
+TEST_F(HamtTest, InvalidBitWidth) {
+  using fc::storage::hamt::kMaxBitWidth;
+  EXPECT_THROW(Hamt(store_, 0), std::system_error);
+  EXPECT_THROW(Hamt(store_, kMaxBitWidth + 1), std::system_error);
+  EXPECT_THROW(Hamt(store_, "010000020000"_cid, 9), std::system_error);
+  try {
+    Hamt{store_, 16};
+    ADD_FAILURE();
+  } catch (const std::system_error &e) {
+    EXPECT_EQ(e.code(), HamtError::INVALID_BIT_WIDTH);
+  }
+  EXPECT_NO_THROW(Hamt(store_, kMaxBitWidth));
+}
+
 /** Flush empty root */
 TEST_F(HamtTest, FlushEmpty) {
   auto cidEmpty =
@@ -302,3 +349,232 @@ TEST_F(HamtTest, PlaceEmpty) {
   EXPECT_OUTCOME_TRUE_1(hamt_.flush());
   EXPECT_OUTCOME_EQ(hamt_.contains("key"), true);
 }
+
+/**
+ * @given flushed HAMT with shards
+ * @when load it, read all keys and flush
+ * @then no nodes are written and root is unchanged
+ * @when set single key and flush
+ * @then only nodes on the path to key are written
+ */
+TEST_F(HamtTest, FlushOnlyModified) {
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("ails", "01"_unhex));
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("aufx", "02"_unhex));
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("bmvm", "03"_unhex));
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("cnyh", "04"_unhex));
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("aai", "05"_unhex));
+  EXPECT_OUTCOME_TRUE(root, hamt_.flush());
+  EXPECT_EQ(hamt_.flushedNodes(), 3);
+
+  hamt_ = {store_, root};
+  EXPECT_OUTCOME_EQ(hamt_.get("ails"), "01"_unhex);
+  EXPECT_OUTCOME_EQ(hamt_.get("cnyh"), "04"_unhex);
+  EXPECT_OUTCOME_EQ(hamt_.get("aai"), "05"_unhex);
+  EXPECT_OUTCOME_EQ(hamt_.flush(), root);
+  EXPECT_EQ(hamt_.flushedNodes(), 0);
+
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("aai", "06"_unhex));
+  EXPECT_OUTCOME_TRUE(root2, hamt_.flush());
+  EXPECT_NE(root2, root);
+  // root and shard containing key, nested shard is untouched
+  EXPECT_EQ(hamt_.flushedNodes(), 2);
+  EXPECT_OUTCOME_EQ(hamt_.get("ails"), "01"_unhex);
+  EXPECT_OUTCOME_EQ(hamt_.get("aai"), "06"_unhex);
+}
+
+/**
+ * @given datastore with decoded cache
+ * @when two HAMT instances load same root
+ * @then second instance reuses nodes decoded by first one
+ */
+TEST_F(HamtTest, DecodedCache) {
+  auto store = std::make_shared<CachedDatastore>(store_, 1 << 20);
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("ails", "01"_unhex));
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("aufx", "02"_unhex));
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("bmvm", "03"_unhex));
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("cnyh", "04"_unhex));
+  EXPECT_OUTCOME_TRUE(root, hamt_.flush());
+
+  EXPECT_OUTCOME_EQ(Hamt(store, root).get("ails"), "01"_unhex);
+  EXPECT_EQ(store->cacheStats().misses, 3);
+  EXPECT_EQ(store->cacheStats().hits, 0);
+
+  EXPECT_OUTCOME_EQ(Hamt(store, root).get("cnyh"), "04"_unhex);
+  EXPECT_EQ(store->cacheStats().misses, 3);
+  EXPECT_EQ(store->cacheStats().hits, 3);
+}
+
+/**
+ * @given datastore with decoded cache and two HAMT instances on same root
+ * @when one instance is read and other one is modified
+ * @then cached nodes are not modified @and instances are independent
+ */
+TEST_F(HamtTest, DecodedCacheSharedNodes) {
+  using fc::storage::hamt::Node;
+  auto store = std::make_shared<CachedDatastore>(store_, 1 << 20);
+  for (auto i = 0; i < 100; ++i) {
+    EXPECT_OUTCOME_TRUE_1(hamt_.setCbor("k" + std::to_string(i), i));
+  }
+  EXPECT_OUTCOME_TRUE(root, hamt_.flush());
+
+  Hamt reader{store, root};
+  Hamt writer{store, root};
+  EXPECT_OUTCOME_EQ(reader.getCbor<int>("k1"), 1);
+  // extra reference to cached root does not change which nodes are copied
+  EXPECT_OUTCOME_TRUE(cached, store->getCborCached<Node>(root));
+  EXPECT_TRUE(cached.cached);
+  EXPECT_OUTCOME_TRUE_1(writer.setCbor("k1", 101));
+  EXPECT_OUTCOME_TRUE_1(writer.remove("k2"));
+  EXPECT_OUTCOME_TRUE_1(reader.visit(
+      [](auto &, auto &) { return fc::outcome::success(); }));
+  EXPECT_OUTCOME_EQ(reader.getCbor<int>("k1"), 1);
+  EXPECT_OUTCOME_EQ(reader.getCbor<int>("k2"), 2);
+  EXPECT_OUTCOME_EQ(writer.getCbor<int>("k1"), 101);
+  EXPECT_OUTCOME_EQ(writer.contains("k2"), false);
+
+  // shared nodes still hold links only, so they encode to same CID
+  EXPECT_OUTCOME_TRUE(bytes, encode(*cached.value));
+  EXPECT_OUTCOME_EQ(fc::common::getCidOf(bytes), root);
+  EXPECT_OUTCOME_EQ(Hamt(store, root).getCbor<int>("k1"), 1);
+  EXPECT_OUTCOME_TRUE(root2, writer.flush());
+  EXPECT_OUTCOME_EQ(Hamt(store, root2).getCbor<int>("k1"), 101);
+}
+
+/**
+ * @given two flushed HAMT roots sharing most of structure
+ * @when diff them
+ * @then only added, removed and modified keys are reported
+ */
+TEST_F(HamtTest, Diff) {
+  using fc::storage::hamt::Change;
+  using fc::storage::hamt::ChangeType;
+  for (auto i = 0; i < 1000; ++i) {
+    EXPECT_OUTCOME_TRUE_1(hamt_.setCbor("k" + std::to_string(i), i));
+  }
+  EXPECT_OUTCOME_TRUE(root1, hamt_.flush());
+  EXPECT_OUTCOME_TRUE_1(hamt_.setCbor("k5", 500));
+  EXPECT_OUTCOME_TRUE_1(hamt_.remove("k7"));
+  EXPECT_OUTCOME_TRUE_1(hamt_.setCbor("new", 1));
+  EXPECT_OUTCOME_TRUE(root2, hamt_.flush());
+
+  std::map<std::string, Change> changes;
+  auto collect = [&](const Change &change) -> fc::outcome::result<void> {
+    changes.emplace(change.key, change);
+    return fc::outcome::success();
+  };
+  EXPECT_OUTCOME_TRUE_1(Hamt::diff(store_, root1, root2, collect));
+  EXPECT_EQ(changes.size(), 3);
+  EXPECT_EQ(changes.at("k5").type, ChangeType::MODIFY);
+  EXPECT_EQ(*changes.at("k5").before, encode(5).value());
+  EXPECT_EQ(*changes.at("k5").after, encode(500).value());
+  EXPECT_EQ(changes.at("k7").type, ChangeType::REMOVE);
+  EXPECT_EQ(*changes.at("k7").before, encode(7).value());
+  EXPECT_FALSE(changes.at("k7").after);
+  EXPECT_EQ(changes.at("new").type, ChangeType::ADD);
+  EXPECT_FALSE(changes.at("new").before);
+
+  changes.clear();
+  EXPECT_OUTCOME_TRUE_1(Hamt::diff(store_, root2, root1, collect));
+  EXPECT_EQ(changes.size(), 3);
+  EXPECT_EQ(changes.at("k7").type, ChangeType::ADD);
+  EXPECT_EQ(changes.at("new").type, ChangeType::REMOVE);
+}
+
+/**
+ * @given equal roots
+ * @when diff them using storage which doesn't contain them
+ * @then no nodes are loaded and no changes are reported
+ */
+TEST_F(HamtTest, DiffEqual) {
+  EXPECT_OUTCOME_TRUE_1(hamt_.set("aai", "05"_unhex));
+  EXPECT_OUTCOME_TRUE(root, hamt_.flush());
+  auto empty = std::make_shared<fc::storage::ipfs::InMemoryDatastore>();
+  EXPECT_OUTCOME_TRUE_1(
+      Hamt::diff(empty, root, root, [](auto &) -> fc::outcome::result<void> {
+        return HamtError::NOT_FOUND;
+      }));
+}
+
+/**
+ * @given flushed hamt with many shards
+ * @when visit it with children loaded concurrently
+ * @then all pairs are visited once in same order as with serial visit
+ */
+TEST_F(HamtTest, VisitExecutor) {
+  boost::asio::thread_pool pool{4};
+  for (auto i = 0; i < 1000; ++i) {
+    EXPECT_OUTCOME_TRUE_1(hamt_.setCbor("k" + std::to_string(i), i));
+  }
+  EXPECT_OUTCOME_TRUE(root, hamt_.flush());
+  auto keys = [&](Hamt &&hamt) {
+    std::vector<std::string> keys;
+    EXPECT_OUTCOME_TRUE_1(hamt.visit([&](auto &key, auto &) {
+      keys.push_back(key);
+      return fc::outcome::success();
+    }));
+    return keys;
+  };
+  Hamt hamt2{store_, root};
+  hamt2.setExecutor(
+      [&pool](auto task) { boost::asio::post(pool, std::move(task)); });
+  auto expected = keys(Hamt{store_, root});
+  EXPECT_EQ(expected.size(), 1000);
+  EXPECT_EQ(keys(std::move(hamt2)), expected);
+}
+
+/**
+ * @given key
+ * @when walk its hash path
+ * @then each level takes next bit width bits of hash
+ */
+TEST_F(HamtTest, HashPath) {
+  using fc::storage::hamt::HashPath;
+  HashPath path{"aai", 8};
+  EXPECT_EQ(path.size(), 8);
+  EXPECT_EQ(path.index(), path.hash() >> 56);
+  EXPECT_EQ(path.next().index(), (path.hash() >> 48) & 0xff);
+  EXPECT_TRUE(path.next().next().next().next().next().next().next().next()
+                  .empty());
+  EXPECT_EQ(HashPath("aai", 5).size(), 12);
+  EXPECT_EQ(path.next().forKey("aai").index(), path.next().index());
+
+  std::string_view key{"aai"};
+  EXPECT_OUTCOME_TRUE_1(hamt_.set(key, "01"_unhex));
+  EXPECT_OUTCOME_EQ(hamt_.get(key), "01"_unhex);
+
+  // bytes key is same key as string with same bytes
+  auto bytes = "616169"_unhex;
+  EXPECT_EQ(HashPath(gsl::make_span(bytes), 8).hash(), path.hash());
+  EXPECT_EQ(path.next().forKey(gsl::make_span(bytes)).index(),
+            path.next().index());
+  EXPECT_OUTCOME_EQ(hamt_.get(bytes), "01"_unhex);
+  EXPECT_OUTCOME_TRUE_1(hamt_.setCbor(bytes, 2));
+  EXPECT_OUTCOME_EQ(hamt_.getCbor<int>(key), 2);
+  EXPECT_OUTCOME_TRUE_1(hamt_.remove(bytes));
+  EXPECT_OUTCOME_EQ(hamt_.contains(bytes), false);
+}
+
+/**
+ * @given loaded HAMT and its snapshot
+ * @when modify and flush snapshot
+ * @then original is not affected
+ */
+TEST_F(HamtTest, CopyOnWrite) {
+  static_assert(!std::is_copy_constructible_v<Hamt>);
+  static_assert(!std::is_copy_assignable_v<Hamt>);
+  for (auto i = 0; i < 100; ++i) {
+    EXPECT_OUTCOME_TRUE_1(hamt_.setCbor(std::to_string(i), i));
+  }
+  auto copy = hamt_.snapshot();
+  EXPECT_OUTCOME_TRUE_1(copy.setCbor("1", 100));
+  EXPECT_OUTCOME_TRUE_1(copy.remove("2"));
+  EXPECT_OUTCOME_TRUE_1(copy.setCbor("new", 1));
+  EXPECT_OUTCOME_TRUE(copy_root, copy.flush());
+
+  EXPECT_OUTCOME_EQ(hamt_.getCbor<int>("1"), 1);
+  EXPECT_OUTCOME_EQ(hamt_.contains("2"), true);
+  EXPECT_OUTCOME_EQ(hamt_.contains("new"), false);
+  EXPECT_OUTCOME_TRUE(root, hamt_.flush());
+  EXPECT_NE(root, copy_root);
+  EXPECT_OUTCOME_EQ(Hamt(store_, copy_root).getCbor<int>("1"), 100);
+}
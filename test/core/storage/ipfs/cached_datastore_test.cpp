@@ -0,0 +1,70 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/impl/cached_datastore.hpp"
+
+#include <gtest/gtest.h>
+
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+
+using fc::storage::ipfs::CachedDatastore;
+using fc::storage::ipfs::InMemoryDatastore;
+using fc::storage::ipfs::IpfsDatastoreError;
+
+class CachedDatastoreTest : public ::testing::Test {
+ public:
+  std::shared_ptr<InMemoryDatastore> inner{
+      std::make_shared<InMemoryDatastore>()};
+  std::shared_ptr<CachedDatastore> store{
+      std::make_shared<CachedDatastore>(inner, 1 << 20)};
+};
+
+/**
+ * @given value stored through decorator
+ * @when get it decoded twice
+ * @then second call returns object decoded by first one
+ */
+TEST_F(CachedDatastoreTest, Hit) {
+  EXPECT_OUTCOME_TRUE(key, store->setCbor(3));
+  EXPECT_OUTCOME_EQ(inner->contains(key), true);
+
+  EXPECT_OUTCOME_TRUE(first, store->getCborCached<int>(key));
+  EXPECT_OUTCOME_TRUE(second, store->getCborCached<int>(key));
+  EXPECT_TRUE(second.cached);
+  EXPECT_EQ(first.value, second.value);
+  EXPECT_EQ(*second.value, 3);
+  EXPECT_EQ(store->cacheStats().hits, 1);
+}
+
+/**
+ * @given value decoded as one type
+ * @when get it decoded as other type
+ * @then cached object is not reused
+ */
+TEST_F(CachedDatastoreTest, OtherType) {
+  EXPECT_OUTCOME_TRUE(key, store->setCbor(3));
+  EXPECT_OUTCOME_TRUE_1(store->getCborCached<int>(key));
+  EXPECT_OUTCOME_TRUE(other, store->getCborCached<uint64_t>(key));
+  EXPECT_EQ(*other.value, 3);
+  EXPECT_EQ(store->cacheStats().hits, 0);
+}
+
+/**
+ * @given cached decoded value
+ * @when remove it from decorator
+ * @then value is removed from wrapped datastore @and decoded object is evicted
+ */
+TEST_F(CachedDatastoreTest, RemoveEvicts) {
+  EXPECT_OUTCOME_TRUE(key, store->setCbor(3));
+  EXPECT_OUTCOME_TRUE_1(store->getCborCached<int>(key));
+  EXPECT_EQ(store->cacheStats().entries, 1);
+
+  EXPECT_OUTCOME_TRUE_1(store->remove(key));
+  EXPECT_EQ(store->cacheStats().entries, 0);
+  EXPECT_OUTCOME_EQ(inner->contains(key), false);
+  EXPECT_OUTCOME_ERROR(IpfsDatastoreError::NOT_FOUND,
+                       store->getCborCached<int>(key));
+}
@@ -0,0 +1,178 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ipfs/ipld_resolver.hpp"
+
+#include <gtest/gtest.h>
+
+#include "primitives/address/address_codec.hpp"
+#include "storage/amt/amt.hpp"
+#include "storage/hamt/hamt.hpp"
+#include "storage/ipfs/impl/in_memory_datastore.hpp"
+#include "testutil/outcome.hpp"
+#include "vm/state/impl/state_tree_impl.hpp"
+
+using fc::CID;
+using fc::codec::cbor::CborResolveError;
+using fc::codec::cbor::encode;
+using fc::common::Buffer;
+using fc::primitives::BigInt;
+using fc::primitives::address::Address;
+using fc::storage::amt::Amt;
+using fc::storage::amt::AmtError;
+using fc::storage::hamt::Hamt;
+using fc::storage::hamt::HamtError;
+using fc::storage::ipfs::InMemoryDatastore;
+using fc::storage::ipfs::IpldResolver;
+using fc::vm::actor::Actor;
+using fc::vm::actor::ActorSubstateCID;
+using fc::vm::actor::CodeId;
+using fc::vm::state::StateTreeImpl;
+using Collection = IpldResolver::Collection;
+using CollectionType = IpldResolver::CollectionType;
+using KeyEncoding = IpldResolver::KeyEncoding;
+
+/**
+ * @given Block linking to other block
+ * @when Resolve paths across link
+ * @then Link is followed in the middle of path and memoized
+ */
+TEST(IpldResolverTest, FollowLinks) {
+  auto ipld = std::make_shared<InMemoryDatastore>();
+  EXPECT_OUTCOME_TRUE(
+      child,
+      ipld->setCbor(std::map<std::string, std::vector<int>>{{"x", {1, 2}}}));
+  EXPECT_OUTCOME_TRUE(root,
+                      ipld->setCbor(std::map<std::string, CID>{{"b", child}}));
+  IpldResolver resolver{ipld, 8};
+
+  EXPECT_OUTCOME_EQ(resolver.resolve(root, {"b", "x", "1"}),
+                    Buffer{encode(2).value()});
+  EXPECT_EQ(resolver.cacheStats().entries, 1);
+  EXPECT_EQ(resolver.cacheStats().hits, 0);
+
+  EXPECT_OUTCOME_EQ(resolver.resolve(root, {"b", "x", "0"}),
+                    Buffer{encode(1).value()});
+  EXPECT_EQ(resolver.cacheStats().hits, 1);
+
+  EXPECT_OUTCOME_EQ(resolver.resolve(root, {"b"}),
+                    Buffer{encode(child).value()});
+  EXPECT_EQ(resolver.cacheStats().hits, 2);
+
+  EXPECT_OUTCOME_ERROR(CborResolveError::KEY_NOT_FOUND,
+                       resolver.resolve(root, {"b", "y"}));
+  EXPECT_OUTCOME_ERROR(CborResolveError::INT_KEY_EXPECTED,
+                       resolver.resolve(root, {"b", "x", "a"}));
+}
+
+/**
+ * @given Block linking to HAMT and AMT roots marked by schema
+ * @when Resolve paths with collection key segments
+ * @then Keys are looked up in collections and links from values followed
+ */
+TEST(IpldResolverTest, CollectionKeys) {
+  auto ipld = std::make_shared<InMemoryDatastore>();
+  EXPECT_OUTCOME_TRUE(
+      head, ipld->setCbor(std::map<std::string, int>{{"x", 5}}));
+  Hamt hamt{ipld};
+  EXPECT_OUTCOME_TRUE_1(hamt.setCbor(
+      "k", std::map<std::string, CID>{{"head", head}}));
+  EXPECT_OUTCOME_TRUE(actors, hamt.flush());
+  Amt amt{ipld};
+  EXPECT_OUTCOME_TRUE_1(amt.setCbor(3, 9));
+  EXPECT_OUTCOME_TRUE(list, amt.flush());
+  EXPECT_OUTCOME_TRUE(root,
+                      ipld->setCbor(std::map<std::string, CID>{
+                          {"actors", actors}, {"list", list}}));
+  IpldResolver resolver{
+      ipld, 8, [](auto &prefix) -> boost::optional<Collection> {
+        if (prefix == IpldResolver::Path{"actors"}) {
+          return Collection{CollectionType::kHamt};
+        }
+        if (prefix == IpldResolver::Path{"list"}) {
+          return Collection{CollectionType::kAmt};
+        }
+        return boost::none;
+      }};
+
+  EXPECT_OUTCOME_EQ(resolver.resolve(root, {"actors"}),
+                    Buffer{encode(actors).value()});
+  EXPECT_OUTCOME_EQ(resolver.resolve(root, {"actors", "k", "head", "x"}),
+                    Buffer{encode(5).value()});
+  EXPECT_OUTCOME_EQ(resolver.resolve(root, {"actors", "k", "head"}),
+                    Buffer{encode(head).value()});
+  EXPECT_EQ(resolver.cacheStats().hits, 2);
+  EXPECT_OUTCOME_ERROR(HamtError::NOT_FOUND,
+                       resolver.resolve(root, {"actors", "z"}));
+
+  EXPECT_OUTCOME_EQ(resolver.resolve(root, {"list", "3"}),
+                    Buffer{encode(9).value()});
+  EXPECT_OUTCOME_ERROR(AmtError::NOT_FOUND,
+                       resolver.resolve(root, {"list", "4"}));
+  EXPECT_OUTCOME_ERROR(CborResolveError::INT_KEY_EXPECTED,
+                       resolver.resolve(root, {"list", "a"}));
+}
+
+/**
+ * @given State tree built by StateTreeImpl, HAMT keyed by address bytes and
+ * HAMT with non-default bit width
+ * @when Resolve paths through them with schema describing their keys
+ * @then Actor and values are found by keys given as path segments
+ */
+TEST(IpldResolverTest, CollectionKeyEncoding) {
+  auto ipld = std::make_shared<InMemoryDatastore>();
+  EXPECT_OUTCOME_TRUE(
+      head, ipld->setCbor(std::map<std::string, int>{{"x", 5}}));
+  auto address = Address::makeFromId(13);
+  StateTreeImpl tree{ipld};
+  EXPECT_OUTCOME_TRUE_1(tree.set(
+      address,
+      Actor{CodeId{head}, ActorSubstateCID{head}, 3, BigInt(5)}));
+  EXPECT_OUTCOME_TRUE(state, tree.flush());
+  IpldResolver state_resolver{
+      ipld, 8, [](auto &prefix) -> boost::optional<Collection> {
+        if (prefix.empty()) {
+          return Collection{CollectionType::kHamt};
+        }
+        return boost::none;
+      }};
+  auto segment = fc::primitives::address::encodeToString(address);
+  EXPECT_OUTCOME_EQ(state_resolver.resolve(state, {segment, "2"}),
+                    Buffer{encode(3).value()});
+  EXPECT_OUTCOME_EQ(state_resolver.resolve(state, {segment, "1", "x"}),
+                    Buffer{encode(5).value()});
+
+  Hamt claims{ipld};
+  EXPECT_OUTCOME_TRUE_1(
+      claims.setCbor(fc::primitives::address::encode(address), 7));
+  EXPECT_OUTCOME_TRUE(claims_root, claims.flush());
+  Hamt narrow{ipld, 5};
+  for (auto i = 0; i < 50; ++i) {
+    EXPECT_OUTCOME_TRUE_1(narrow.setCbor(std::to_string(i), i));
+  }
+  EXPECT_OUTCOME_TRUE(narrow_root, narrow.flush());
+  EXPECT_OUTCOME_TRUE(root,
+                      ipld->setCbor(std::map<std::string, CID>{
+                          {"claims", claims_root}, {"narrow", narrow_root}}));
+  IpldResolver resolver{
+      ipld, 8, [](auto &prefix) -> boost::optional<Collection> {
+        if (prefix == IpldResolver::Path{"claims"}) {
+          return Collection{CollectionType::kHamt, KeyEncoding::kAddress};
+        }
+        if (prefix == IpldResolver::Path{"narrow"}) {
+          return Collection{CollectionType::kHamt, KeyEncoding::kString, 5};
+        }
+        return boost::none;
+      }};
+  EXPECT_OUTCOME_EQ(resolver.resolve(root, {"claims", segment}),
+                    Buffer{encode(7).value()});
+  EXPECT_OUTCOME_ERROR(HamtError::NOT_FOUND,
+                       resolver.resolve(root, {"claims", "t014"}));
+  EXPECT_FALSE(resolver.resolve(root, {"claims", "x"}));
+  for (auto i = 0; i < 50; ++i) {
+    EXPECT_OUTCOME_EQ(resolver.resolve(root, {"narrow", std::to_string(i)}),
+                      Buffer{encode(i).value()});
+  }
+}
@@ -8,6 +8,7 @@
 #include <gtest/gtest.h>
 #include "primitives/address/address_codec.hpp"
 #include "testutil/init_actor.hpp"
+#include "testutil/mocks/storage/ipfs/ipfs_datastore_mock.hpp"
 
 using fc::primitives::BigInt;
 using fc::primitives::address::Address;
@@ -16,6 +17,7 @@ using fc::storage::hamt::HamtError;
 using fc::vm::actor::Actor;
 using fc::vm::actor::ActorSubstateCID;
 using fc::vm::actor::CodeId;
+using fc::vm::state::StateTreeError;
 using fc::vm::state::StateTreeImpl;
 
 auto kAddressId = Address::makeFromId(13);
@@ -65,6 +67,102 @@ TEST_F(StateTreeTest, SetRevert) {
   EXPECT_OUTCOME_ERROR(HamtError::NOT_FOUND, tree_.get(kAddressId));
 }
 
+/**
+ * @given State tree with nested checkpoints
+ * @when Revert and commit checkpoints
+ * @then Tree state is restored to corresponding checkpoint
+ */
+TEST_F(StateTreeTest, Checkpoints) {
+  auto actor2 = kActor;
+  actor2.nonce = 4;
+  auto address_id2 = Address::makeFromId(14);
+  EXPECT_OUTCOME_TRUE_1(tree_.set(kAddressId, kActor));
+  tree_.checkpoint();
+  EXPECT_OUTCOME_TRUE_1(tree_.set(kAddressId, actor2));
+  tree_.checkpoint();
+  EXPECT_OUTCOME_TRUE_1(tree_.set(address_id2, kActor));
+  EXPECT_OUTCOME_TRUE_1(tree_.revertCheckpoint());
+  EXPECT_OUTCOME_ERROR(HamtError::NOT_FOUND, tree_.get(address_id2));
+  EXPECT_OUTCOME_EQ(tree_.get(kAddressId), actor2);
+  EXPECT_OUTCOME_TRUE_1(tree_.revertCheckpoint());
+  EXPECT_OUTCOME_EQ(tree_.get(kAddressId), kActor);
+
+  tree_.checkpoint();
+  EXPECT_OUTCOME_TRUE_1(tree_.set(address_id2, kActor));
+  EXPECT_OUTCOME_TRUE_1(tree_.commitCheckpoint());
+  EXPECT_OUTCOME_EQ(tree_.get(address_id2), kActor);
+  EXPECT_OUTCOME_ERROR(StateTreeError::NO_CHECKPOINT, tree_.revertCheckpoint());
+}
+
+/**
+ * @given State tree with checkpoints taken before revert or flush
+ * @when Revert or flush tree and then revert checkpoint
+ * @then Checkpoints are dropped, reverted state is not brought back
+ */
+TEST_F(StateTreeTest, RevertFlushDropCheckpoints) {
+  auto address_id2 = Address::makeFromId(14);
+  tree_.checkpoint();
+  EXPECT_OUTCOME_TRUE_1(tree_.set(kAddressId, kActor));
+  tree_.checkpoint();
+  EXPECT_OUTCOME_TRUE_1(tree_.revert());
+  EXPECT_OUTCOME_ERROR(StateTreeError::NO_CHECKPOINT, tree_.revertCheckpoint());
+  EXPECT_OUTCOME_ERROR(HamtError::NOT_FOUND, tree_.get(kAddressId));
+
+  EXPECT_OUTCOME_TRUE_1(tree_.set(kAddressId, kActor));
+  tree_.checkpoint();
+  EXPECT_OUTCOME_TRUE_1(tree_.set(address_id2, kActor));
+  EXPECT_OUTCOME_TRUE(root, tree_.flush());
+  EXPECT_OUTCOME_ERROR(StateTreeError::NO_CHECKPOINT,
+                       tree_.commitCheckpoint());
+  EXPECT_OUTCOME_TRUE_1(tree_.revert());
+  EXPECT_OUTCOME_EQ(tree_.get(address_id2), kActor);
+  EXPECT_OUTCOME_EQ(tree_.flush(), root);
+}
+
+/**
+ * @given State tree loaded from storage without decoded cache
+ * @when Read actor, take checkpoint, read all actors and read them again
+ * with more checkpoints
+ * @then Nodes loaded by first reads are reused, storage is not read again
+ */
+TEST_F(StateTreeTest, CheckpointKeepsLoadedNodes) {
+  using fc::storage::ipfs::MockIpfsDatastore;
+  using testing::_;
+  for (auto id = 0; id < 1000; ++id) {
+    EXPECT_OUTCOME_TRUE_1(tree_.set(Address::makeFromId(id), kActor));
+  }
+  EXPECT_OUTCOME_TRUE(root, tree_.flush());
+  auto gets = 0;
+  auto mock = std::make_shared<MockIpfsDatastore>();
+  EXPECT_CALL(*mock, get(_)).WillRepeatedly([&](auto &key) {
+    ++gets;
+    return store_->get(key);
+  });
+  StateTreeImpl tree{mock, root};
+  auto readAll = [&] {
+    for (auto id = 0; id < 1000; ++id) {
+      EXPECT_OUTCOME_EQ(tree.get(Address::makeFromId(id)), kActor);
+    }
+  };
+
+  // load root before checkpoint, as after any read in message
+  EXPECT_OUTCOME_EQ(tree.get(kAddressId), kActor);
+  tree.checkpoint();
+  readAll();
+  auto loaded = gets;
+  EXPECT_GT(loaded, 1);
+  readAll();
+  EXPECT_EQ(gets, loaded);
+  tree.checkpoint();
+  EXPECT_OUTCOME_TRUE_1(tree.set(kAddressId, kActor));
+  readAll();
+  EXPECT_OUTCOME_TRUE_1(tree.revertCheckpoint());
+  readAll();
+  EXPECT_OUTCOME_TRUE_1(tree.revertCheckpoint());
+  readAll();
+  EXPECT_EQ(gets, loaded);
+}
+
 /**
  * @given State tree and actor state
  * @when Register new actor address and state
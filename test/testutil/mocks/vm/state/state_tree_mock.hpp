@@ -23,6 +23,9 @@ namespace fc::vm::state {
                                           const Actor &actor));
     MOCK_METHOD0(flush, outcome::result<CID>());
     MOCK_METHOD0(revert, outcome::result<void>());
+    MOCK_METHOD0(checkpoint, void());
+    MOCK_METHOD0(revertCheckpoint, outcome::result<void>());
+    MOCK_METHOD0(commitCheckpoint, outcome::result<void>());
     MOCK_METHOD0(getStore, std::shared_ptr<IpfsDatastore>());
   };
 